@@ -39,6 +39,10 @@ network/CNetworkThread.cpp
 network/CNetworkThread.h
 network/CPacketManager.cpp
 network/CPacketManager.h
+network/CPacketPool.cpp
+network/CPacketPool.h
+network/CPacketStats.cpp
+network/CPacketStats.h
 network/CSocket.cpp
 network/CSocket.h
 network/linuxev.cpp
@@ -63,6 +67,8 @@ common/crypto/CBCrypt.h
 common/crypto/CCrypto.cpp
 common/crypto/CCrypto.h
 common/crypto/CCryptoBlowFish.cpp
+common/crypto/CCryptoClient.cpp
+common/crypto/CCryptoCore.cpp
 common/crypto/CCryptoHuffman.cpp
 common/crypto/CCryptoLogin.cpp
 common/crypto/CCryptoMD5Interface.cpp
@@ -146,6 +152,8 @@ common/CScript.cpp
 common/CScript.h
 common/CScriptContexts.cpp
 common/CScriptContexts.h
+common/CScriptNatives.cpp
+common/CScriptNatives.h
 common/CScriptObj.cpp
 common/CScriptObj.h
 common/CScriptTriggerArgs.cpp
@@ -225,6 +233,8 @@ SOURCE_GROUP (common\\resource\\sections FILES ${resourcesections_SRCS})
 SET (spherelibrary_SRCS
 common/sphere_library/CSAssoc.cpp
 common/sphere_library/CSAssoc.h
+common/sphere_library/CSAtom.cpp
+common/sphere_library/CSAtom.h
 common/sphere_library/CSFile.cpp
 common/sphere_library/CSFile.h
 common/sphere_library/CSFileList.cpp
@@ -560,6 +570,39 @@ tables/triggers.tbl
 )
 SOURCE_GROUP (tables FILES ${tables_SRCS})
 
+# Headless client simulator (separate executable, see tools/headless/HeadlessDriver.cpp)
+SET (headless_SRCS
+tools/headless/HeadlessClient.cpp
+tools/headless/HeadlessClient.h
+tools/headless/HeadlessDriver.cpp
+tools/headless/HeadlessProtocol.cpp
+tools/headless/HeadlessProtocol.h
+tools/headless/HeadlessSocket.cpp
+tools/headless/HeadlessSocket.h
+)
+SOURCE_GROUP (tools\\headless FILES ${headless_SRCS})
+
+# Server files the headless client links too: the bots encrypt their traffic with the server's own code
+SET (headless_crypto_SRCS
+common/crypto/CCrypto.h
+common/crypto/CCryptoClient.cpp
+common/crypto/CCryptoCore.cpp
+common/crypto/CCryptoHuffman.cpp
+common/crypto/CCryptoLogin.cpp
+common/crypto/CCryptoMD5Interface.cpp
+common/crypto/CCryptoTwoFishInterface.cpp
+common/crypto/CMD5.cpp
+common/crypto/CMD5.h
+common/crypto/twofish/twofish.cpp
+common/crypto/twofish/twofish.h
+)
+
+# Unit tests (separate executables, see ../tests)
+SET (test_threadsafequeue_SRCS
+../tests/ThreadSafeQueueTest.cpp
+common/sphere_library/smutex.cpp
+)
+
 # Misc doc and *.ini files
 SET (docs_TEXT
 ../Changelog-X1-Nightlies.txt
@@ -0,0 +1,279 @@
+#include "../game/CContainer.h"
+#include "../game/CObjBase.h"
+#include "../game/CServerConfig.h"
+#include "../game/CWorldMap.h"
+#include "../game/items/CItem.h"
+#include "CExpression.h"
+#include "CLog.h"
+#include "CScriptNatives.h"
+#include "CUID.h"
+
+
+namespace
+{
+	// Builtins: the most used intrinsics of CExpression, also callable as <NAME(...)> without an EVAL.
+	// Same results as the intrinsics, e.g. MAX with a single argument gives 0 and STRLEN counts the whole text.
+
+	bool NativeRand(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		if (call.m_iArgs == 2)
+			llResult = Calc_GetRandLLVal2(call.m_llArgs[0], call.m_llArgs[1]);
+		else
+			llResult = Calc_GetRandLLVal(call.m_llArgs[0]);
+		return true;
+	}
+
+	bool NativeStrLen(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		llResult = (llong)strlen(call.m_ptcArgs[0]);
+		return true;
+	}
+
+	bool NativeMin(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		llResult = (call.m_iArgs < 2) ? 0 : minimum(call.m_llArgs[0], call.m_llArgs[1]);
+		return true;
+	}
+
+	bool NativeMax(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		llResult = (call.m_iArgs < 2) ? 0 : maximum(call.m_llArgs[0], call.m_llArgs[1]);
+		return true;
+	}
+
+	bool NativeAbs(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		llResult = llabs(call.m_llArgs[0]);
+		return true;
+	}
+
+	// Object context: distance between the (top level) object running the script and the given one, like <DISTANCE uid>.
+	bool NativeDistTo(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		const CObjBase * pThis = dynamic_cast<const CObjBase *>(call.m_pObj);
+		const CObjBase * pObj = call.m_ppObjArgs[0];
+		if ((pThis == nullptr) || (pObj == nullptr))
+			return false;
+
+		if (!pThis->IsTopLevel())
+			pThis = dynamic_cast<const CObjBase *>(pThis->GetTopLevelObj());
+		if (!pObj->IsTopLevel())
+			pObj = dynamic_cast<const CObjBase *>(pObj->GetTopLevelObj());
+		if ((pThis == nullptr) || (pObj == nullptr))
+			return false;
+
+		llResult = pThis->GetDist(pObj);
+		return true;
+	}
+
+	// Object context: like <ISNEARTYPE type,distance,multi>, is an item of the given type near the object running the script.
+	bool NativeIsNearType(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		const CObjBase * pThis = dynamic_cast<const CObjBase *>(call.m_pObj);
+		if (pThis == nullptr)
+			return false;
+
+		const CPointMap & pt = pThis->GetTopPoint();
+		if (!pt.IsValidPoint())
+		{
+			llResult = 0;
+			return true;
+		}
+		const int iType = g_Cfg.ResourceGetIndexType(RES_TYPEDEF, call.m_ptcArgs[0]);
+		llResult = CWorldMap::IsItemTypeNear(pt, (IT_TYPE)iType, (int)call.m_llArgs[1], (call.m_llArgs[2] != 0));
+		return true;
+	}
+
+	// Container (or char) context: like <FINDID.id.UID>, UID of the first item with the given id in it, 0 if there isn't one.
+	bool NativeFindId(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		const CContainer * pCont = dynamic_cast<const CContainer *>(call.m_pObj);
+		if (pCont == nullptr)
+			return false;
+
+		const CItem * pItem = pCont->ContentFind(g_Cfg.ResourceGetID(RES_ITEMDEF, call.m_ptcArgs[0]));
+		llResult = (pItem == nullptr) ? 0 : (llong)pItem->GetUID().GetObjUID();
+		return true;
+	}
+
+	// Container (or char) context: like <RESCOUNT id>, amount of items with the given id in it, or all of its items without id.
+	bool NativeResCount(const CScriptNatives::Call_s & call, llong & llResult)
+	{
+		const CContainer * pCont = dynamic_cast<const CContainer *>(call.m_pObj);
+		if (pCont == nullptr)
+			return false;
+
+		if (call.m_iArgs > 0)
+			llResult = pCont->ContentCount(g_Cfg.ResourceGetID(RES_ITEMDEF, call.m_ptcArgs[0]));
+		else
+			llResult = (llong)pCont->GetContentCount();
+		return true;
+	}
+}
+
+
+CScriptNatives::CScriptNatives()
+{
+	Register("ABS", "n", NativeAbs);
+	Register("MAX", "n|n", NativeMax);
+	Register("MIN", "n|n", NativeMin);
+	Register("RAND", "n|n", NativeRand);
+	Register("STRLEN", "r", NativeStrLen);
+
+	Register("DISTTO", "o", NativeDistTo);
+	Register("FINDID", "s", NativeFindId);
+	Register("ISNEARTYPE", "s|nn", NativeIsNearType);
+	Register("RESCOUNT", "|s", NativeResCount);
+}
+
+CScriptNatives & CScriptNatives::Get() // static
+{
+	static CScriptNatives s_Natives;
+	return s_Natives;
+}
+
+bool CScriptNatives::Register(lpctstr ptcName, lpctstr ptcSignature, NATIVE_FUNC pFunc)
+{
+	ADDTOCALLSTACK("CScriptNatives::Register");
+	ASSERT(pFunc);
+
+	bool fValidName = (ptcName != nullptr) && (ptcName[0] != '\0');
+	for (lpctstr ptcChar = ptcName; fValidName && (*ptcChar != '\0'); ++ptcChar)
+		fValidName = (IsAlnum(*ptcChar) || (*ptcChar == '_'));
+	if (!fValidName)
+	{
+		g_Log.EventError("Invalid name '%s' for a native function.\n", ptcName ? ptcName : "");
+		return false;
+	}
+
+	Native_s native;
+	native.m_sName = ptcName;
+	native.m_iArgs = 0;
+	native.m_iMinArgs = -1;
+	native.m_pFunc = pFunc;
+
+	for (lpctstr ptcSig = ptcSignature; *ptcSig != '\0'; ++ptcSig)
+	{
+		const tchar ch = static_cast<tchar>(tolower(*ptcSig));
+		if ((ch == '|') && (native.m_iMinArgs < 0))
+		{
+			native.m_iMinArgs = native.m_iArgs;
+			continue;
+		}
+		const bool fRawAlone = (ch != 'r') || ((native.m_iArgs == 0) && (ptcSig[1] == '\0'));
+		if (((ch != 'n') && (ch != 's') && (ch != 'o') && (ch != 'r')) || !fRawAlone || (native.m_iArgs >= kiMaxArgs))
+		{
+			g_Log.EventError("Invalid signature '%s' for the native function '%s'.\n", ptcSignature, ptcName);
+			return false;
+		}
+		native.m_pchArgTypes[native.m_iArgs++] = ch;
+	}
+	if (native.m_iMinArgs < 0)
+		native.m_iMinArgs = native.m_iArgs;
+
+	// The key points to the text of the atom, it stays where it is when the native is moved in the map.
+	const std::string_view svName(native.m_sName.GetBuffer(), native.m_sName.GetLength());
+	if (!m_Natives.emplace(svName, std::move(native)).second)
+	{
+		g_Log.EventError("Native function '%s' is already registered.\n", ptcName);
+		return false;
+	}
+	return true;
+}
+
+const CScriptNatives::Native_s * CScriptNatives::Find(lpctstr ptcKey) const
+{
+	// No ADDTOCALLSTACK: called for each <...> statement.
+	size_t uiLen = 0;
+	while (IsAlnum(ptcKey[uiLen]) || (ptcKey[uiLen] == '_'))
+		++uiLen;
+	if ((uiLen == 0) || (ptcKey[uiLen] != '('))
+		return nullptr;
+
+	const auto it = m_Natives.find(std::string_view(ptcKey, uiLen));
+	return (it == m_Natives.end()) ? nullptr : &it->second;
+}
+
+bool CScriptNatives::Call(const Native_s & native, lpctstr ptcKey, CScriptObj * pObj, CTextConsole * pSrc, CScriptTriggerArgs * pArgs, llong & llResult) // static
+{
+	ADDTOCALLSTACK("CScriptNatives::Call");
+
+	// Parse a copy of the arguments: if they are wrong, the statement text must stay as it is.
+	tchar * ptcArgs = Str_GetTemp();
+	Str_CopyLimitNull(ptcArgs, ptcKey + native.m_sName.GetLength() + 1, STR_TEMPLENGTH);	// past the '('
+
+	tchar * ptcEnd = strrchr(ptcArgs, ')');
+	if (ptcEnd == nullptr)
+		return false;
+	*ptcEnd = '\0';
+	++ptcEnd;
+	GETNONWHITESPACE(ptcEnd);
+	if (*ptcEnd != '\0')
+		return false;	// something after the closing bracket
+
+	Call_s call;
+	call.m_pObj = pObj;
+	call.m_pSrc = pSrc;
+	call.m_pArgs = pArgs;
+
+	// As the intrinsics do, the last argument gets the rest of the text, commas included.
+	tchar * ppArgs[kiMaxArgs];
+	if ((native.m_iArgs == 1) && (native.m_pchArgTypes[0] == 'r'))
+	{
+		call.m_iArgs = 1;
+		ppArgs[0] = ptcArgs;
+	}
+	else if (native.m_iArgs > 1)
+	{
+		call.m_iArgs = Str_ParseCmds(ptcArgs, ppArgs, native.m_iArgs, ",");
+	}
+	else
+	{
+		ppArgs[0] = Str_TrimWhitespace(ptcArgs);
+		call.m_iArgs = ((native.m_iArgs == 1) && (ppArgs[0][0] != '\0')) ? 1 : 0;
+	}
+	if (call.m_iArgs < native.m_iMinArgs)
+	{
+		DEBUG_ERR(("Native function '%s' expects %d to %d arguments, %d given.\n", native.m_sName.GetBuffer(), native.m_iMinArgs, native.m_iArgs, call.m_iArgs));
+		return false;
+	}
+
+	for (int i = 0; i < kiMaxArgs; ++i)
+	{
+		call.m_llArgs[i] = 0;
+		call.m_ptcArgs[i] = "";
+		call.m_ppObjArgs[i] = nullptr;
+		if (i >= call.m_iArgs)
+			continue;
+
+		if (native.m_pchArgTypes[i] == 'r')
+		{
+			call.m_ptcArgs[i] = ppArgs[i];
+			continue;
+		}
+
+		tchar * ptcArg = Str_TrimWhitespace(ppArgs[i]);
+		switch (native.m_pchArgTypes[i])
+		{
+			case 'n':
+			{
+				lpctstr ptcVal = ptcArg;
+				call.m_llArgs[i] = Exp_GetLLVal(ptcVal);
+				break;
+			}
+			case 'o':
+			{
+				lpctstr ptcVal = ptcArg;
+				const dword dwUID = Exp_GetDWVal(ptcVal);
+				call.m_llArgs[i] = dwUID;
+				call.m_ppObjArgs[i] = CUID::ObjFindFromUID(dwUID);
+				break;
+			}
+			default:	// 's'
+				call.m_ptcArgs[i] = ptcArg;
+				break;
+		}
+	}
+
+	return native.m_pFunc(call, llResult);
+}
@@ -0,0 +1,87 @@
+/**
+* @file CScriptNatives.h
+* @brief Functions implemented in C++ and callable from the scripts.
+*/
+
+#ifndef _INC_CSCRIPTNATIVES_H
+#define _INC_CSCRIPTNATIVES_H
+
+#include "parallel_hashmap/phmap.h"
+#include "sphere_library/CSAtom.h"
+#include "common.h"
+
+class CObjBase;
+class CScriptObj;
+class CScriptTriggerArgs;
+class CTextConsole;
+
+
+class CScriptNatives
+{
+	// Natives are written in the scripts as <NAME(arg1,arg2...)>. The arguments are parsed following the signature given
+	// at the registration, the function gets them already as numbers, strings or objects, and its numeric result replaces
+	// the statement: no keyword lookup on the object running the script, no intermediate text.
+	// They are looked for before the object keywords, so a native hides a keyword with the same name (only when called with
+	// the parentheses). A script [FUNCTION] with the same name is called instead of the native, and if the arguments are
+	// wrong the statement is evaluated as if the native didn't exist.
+	// The natives written in a script section are found when the section is loaded (CResourceLink::ScanSection): running the
+	// line doesn't look for them again. Only a name built at runtime by another <...>, or a text outside of the sections, is
+	// looked for when evaluated.
+	// Register them when the server starts, before the scripts are loaded: the lookups don't lock.
+
+public:
+	static constexpr int kiMaxArgs = 8;
+
+	struct Call_s
+	{
+		CScriptObj * m_pObj;				// object running the script
+		CTextConsole * m_pSrc;
+		CScriptTriggerArgs * m_pArgs;		// can be nullptr
+		int m_iArgs;						// arguments given, the optional ones can be missing
+		llong m_llArgs[kiMaxArgs];			// 'n' arguments, and UIDs of the 'o' ones
+		lpctstr m_ptcArgs[kiMaxArgs];		// 's' and 'r' arguments
+		CObjBase * m_ppObjArgs[kiMaxArgs];	// 'o' arguments, nullptr if not a valid object
+	};
+
+	// RETURN: false = bad arguments.
+	typedef bool (*NATIVE_FUNC)(const Call_s & call, llong & llResult);
+
+	struct Native_s
+	{
+		CSAtomRef m_sName;
+		char m_pchArgTypes[kiMaxArgs];		// 'n' = number, 's' = string, 'o' = object (UID), 'r' = raw text of all the arguments
+		int m_iArgs;
+		int m_iMinArgs;
+		NATIVE_FUNC m_pFunc;
+	};
+
+private:
+	// Keys are the m_sName of the natives. Node based: the scanned sections keep pointers to the natives.
+	phmap::node_hash_map<std::string_view, Native_s, StrViewHashI_s, StrViewEqualI_s> m_Natives;
+
+public:
+	CScriptNatives();
+	~CScriptNatives() = default;
+
+private:
+	CScriptNatives(const CScriptNatives& copy);
+	CScriptNatives& operator=(const CScriptNatives& other);
+
+public:
+	static CScriptNatives & Get();
+
+	// ptcSignature: a letter for each argument ('n', 's' or 'o'), the ones after a '|' are optional. E.g.: "n|n".
+	//  "r" (alone) gets the whole text between the parentheses, untrimmed and with its commas.
+	// RETURN: false = invalid signature or name already used.
+	bool Register(lpctstr ptcName, lpctstr ptcSignature, NATIVE_FUNC pFunc);
+
+	// ptcKey: text of the statement, "NAME(args)".
+	// RETURN: nullptr = not a native.
+	const Native_s * Find(lpctstr ptcKey) const;
+
+	// RETURN: false = bad arguments (ptcKey is left untouched).
+	static bool Call(const Native_s & native, lpctstr ptcKey, CScriptObj * pObj, CTextConsole * pSrc, CScriptTriggerArgs * pArgs, llong & llResult);
+};
+
+
+#endif // _INC_CSCRIPTNATIVES_H
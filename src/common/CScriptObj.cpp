@@ -23,6 +23,7 @@
 #include "CFloatMath.h"
 #include "CExpression.h"
 #include "CSFileObjContainer.h"
+#include "CScriptNatives.h"
 #include "CScriptTriggerArgs.h"
 
 class CStoneMember;
@@ -56,6 +57,49 @@ static lpctstr const _ptcSRefKeys[SREF_QTY+1] =
     nullptr
 };
 
+namespace
+{
+	// Strings receiving the values of the <...> statements evaluated by ParseScriptText.
+	// They are reused, keeping their buffer, instead of allocating a new CSString for each statement.
+	// r_WriteVal can run other scripts (functions, triggers...), so each nested evaluation takes the next one in the stack.
+	class ParseScriptTextValue
+	{
+		static constexpr int kiMaxKeptCapacity = 4 * 1024;	// bigger buffers are freed after use
+
+		static thread_local std::vector<std::unique_ptr<CSString>> sm_vValues;
+		static thread_local size_t sm_uiUsed;
+
+		CSString * m_psVal;
+
+	public:
+		ParseScriptTextValue()
+		{
+			if (sm_uiUsed == sm_vValues.size())
+				sm_vValues.emplace_back(std::make_unique<CSString>());
+			m_psVal = sm_vValues[sm_uiUsed++].get();
+			m_psVal->Clear();
+		}
+		~ParseScriptTextValue() noexcept
+		{
+			--sm_uiUsed;
+			if (m_psVal->GetCapacity() > kiMaxKeptCapacity)
+				sm_vValues[sm_uiUsed] = std::make_unique<CSString>();
+		}
+
+	private:
+		ParseScriptTextValue(const ParseScriptTextValue& copy);
+		ParseScriptTextValue& operator=(const ParseScriptTextValue& other);
+
+	public:
+		inline CSString & Get() noexcept {
+			return *m_psVal;
+		}
+	};
+
+	thread_local std::vector<std::unique_ptr<CSString>> ParseScriptTextValue::sm_vValues;
+	thread_local size_t ParseScriptTextValue::sm_uiUsed = 0;
+}
+
 CScriptObj::CScriptObj()
 {
 	_iParseScriptText_Reentrant = 0;
@@ -1723,6 +1767,7 @@ size_t CScriptObj::ParseScriptText( tchar * ptcResponse, CTextConsole * pSrc, in
 	enum class QvalStatus { None, Condition, Returns, End } eQval = QvalStatus::None;
 	int iQvalOpenBrackets = 0;
 
+	bool fNestedStatement = false;	// part of the statement comes from a nested <...>: its name can be one written by no script line
 	size_t iBegin = 0;
 	size_t i = 0;
 	EXC_TRY("ParseScriptText Main Loop");
@@ -1742,6 +1787,7 @@ size_t CScriptObj::ParseScriptText( tchar * ptcResponse, CTextConsole * pSrc, in
 				// Set the statement start
 				iBegin = i;
 				_fParseScriptText_Brackets = true;
+				fNestedStatement = false;
 
 				// Set-up to process special statements: is it a QVAL?
 				const bool fIsQval = !strnicmp(ptcResponse + i + 1, "QVAL", 4);
@@ -1828,6 +1874,7 @@ size_t CScriptObj::ParseScriptText( tchar * ptcResponse, CTextConsole * pSrc, in
 			// Parse what's inside the open bracket
 			tchar* ptcRecurseParse = ptcResponse + i;
 			const size_t ilen = ParseScriptText(ptcRecurseParse, pSrc, 2, pArgs );
+			fNestedStatement = true;
 
 			_fParseScriptText_Brackets = true;
 			--_iParseScriptText_Reentrant;
@@ -1892,7 +1939,8 @@ size_t CScriptObj::ParseScriptText( tchar * ptcResponse, CTextConsole * pSrc, in
 			ptcResponse[i] = '\0'; // Needed for r_WriteVal
 			lpctstr ptcKey = ptcResponse + iBegin + 1; // move past the opening bracket
 
-			CSString sVal;
+			ParseScriptTextValue value;
+			CSString & sVal = value.Get();
 			bool fRes;
 			if (eQval != QvalStatus::None)
 			{
@@ -1904,10 +1952,35 @@ size_t CScriptObj::ParseScriptText( tchar * ptcResponse, CTextConsole * pSrc, in
 			}
 			else
 			{
-				// Standard evaluation for everything else
-				EXC_SET_BLOCK("writeval generic");
-				fRes = r_WriteVal(ptcKey, sVal, pSrc);
+				fRes = false;
+				// The natives written in the line were found when its section was scanned, look for the others now.
+				const CScriptNatives::Native_s * pNative = nullptr;
+				if (fNestedStatement || (pArgs == nullptr) || !pArgs->GetLineNative(ptcKey, &pNative))
+					pNative = CScriptNatives::Get().Find(ptcKey);
+				if ((pNative != nullptr) && !r_CanCall(r_GetFunctionIndex(ptcKey)))	// a script [FUNCTION] with the same name has precedence
+				{
+					// Function implemented in C++: gets its arguments already parsed and returns a number.
+					EXC_SET_BLOCK("writeval native");
+					llong llResult;
+					fRes = CScriptNatives::Call(*pNative, ptcKey, this, pSrc, pArgs, llResult);
+					if (fRes)
+						sVal.FormatLLVal(llResult);
+				}
+
+				// Standard evaluation for everything else (natives with wrong arguments included)
+				const bool fArgsFirst = ((fRes == false) && (pArgs != nullptr) && CScriptTriggerArgs::IsArgsKey(ptcKey));
+				if (fArgsFirst)
+				{
+					// LOCALs and ARGs are the most used keys: resolve them directly in the args, without walking the object's keywords.
+					EXC_SET_BLOCK("writeval args first");
+					fRes = pArgs->r_WriteVal(ptcKey, sVal, pSrc);
+				}
 				if (fRes == false)
+				{
+					EXC_SET_BLOCK("writeval generic");
+					fRes = r_WriteVal(ptcKey, sVal, pSrc);
+				}
+				if ((fRes == false) && !fArgsFirst)
 				{
 					EXC_SET_BLOCK("writeval args");
 					// write the value of functions or triggers variables/objects like ARGO, ARGN1/2/3, LOCALs...
@@ -2097,6 +2170,15 @@ bool CScriptObj::Execute_FullTrigger(CScript& s, CTextConsole* pSrc, CScriptTrig
 bool CScriptObj::OnTriggerFind( CScript & s, lpctstr pszTrigName )
 {
 	ADDTOCALLSTACK("CScriptObj::OnTriggerFind");
+	// Sections linked at load time know where their triggers are, jump straight to the body.
+	const CResourceLock * pLock = dynamic_cast<const CResourceLock *>(&s);
+	const CResourceLink * pLink = pLock ? pLock->GetLink() : nullptr;
+	if ( pLink && pLink->HasTriggerContexts() )
+	{
+		const CScriptLineContext * pContext = pLink->FindTriggerContext(pszTrigName);
+		return ( pContext && s.SeekContext(*pContext) );
+	}
+
 	while ( s.ReadKey(false) )
 	{
 		// Is it a trigger ?
@@ -2266,6 +2348,52 @@ lpctstr const CScriptObj::sm_szScriptKeys[SK_QTY+1] =
 	nullptr
 };
 
+SCRIPTBLOCK_TYPE CScriptObj::GetScriptBlockType( lpctstr ptcKey )
+{
+	// Must match the way OnTriggerRun walks a TRIGRUN_SECTION_FALSE block.
+	switch ( FindTableSorted( ptcKey, sm_szScriptKeys, CountOf( sm_szScriptKeys )-1 ) )
+	{
+		case SK_IF:
+			return SCRIPTBLOCK_IF;
+
+		case SK_WHILE:
+		case SK_FOR:
+		case SK_FORCHARLAYER:
+		case SK_FORCHARMEMORYTYPE:
+		case SK_FORCHAR:
+		case SK_FORCLIENTS:
+		case SK_FORCONT:
+		case SK_FORCONTID:
+		case SK_FORCONTTYPE:
+		case SK_FORINSTANCE:
+		case SK_FORITEM:
+		case SK_FOROBJ:
+		case SK_FORPLAYERS:
+		case SK_FORTIMERF:
+		case SK_DORAND:
+		case SK_DOSWITCH:
+		case SK_BEGIN:
+			return SCRIPTBLOCK_OPEN;
+
+		case SK_ELIF:
+		case SK_ELSEIF:
+		case SK_ELSE:
+			return SCRIPTBLOCK_ELSE;
+
+		case SK_ENDIF:
+		case SK_END:
+		case SK_ENDDO:
+		case SK_ENDFOR:
+		case SK_ENDRAND:
+		case SK_ENDSWITCH:
+		case SK_ENDWHILE:
+			return SCRIPTBLOCK_END;
+
+		default:
+			return SCRIPTBLOCK_NONE;
+	}
+}
+
 TRIGRET_TYPE CScriptObj::OnTriggerLoopGeneric(CScript& s, int iType, CTextConsole* pSrc, CScriptTriggerArgs* pArgs, CSString* pResult)
 {
 	ADDTOCALLSTACK("CScriptObj::OnTriggerLoopGeneric");
@@ -2758,6 +2886,44 @@ TRIGRET_TYPE CScriptObj::OnTriggerLoopForContSpecial(CScript& s, SK_TYPE iCmd, C
 	return iRet;
 }
 
+#ifdef _DEBUG
+static int SkipBlockByLines( CScript & s, CScriptLineContext & endContext )
+{
+	// Skip a block reading it line by line, as OnTriggerRun did with TRIGRUN_SECTION_FALSE before the block ends were matched at load time.
+	// RETURN: SCRIPTBLOCK_ELSE or SCRIPTBLOCK_END, endContext = the start of that line. -1 if it ran into the next trigger or the end of the section.
+	for (;;)
+	{
+		const CScriptLineContext lineContext = s.GetContext();
+		if ( !s.ReadKeyParse() || s.IsKeyHead( "ON", 2 ) )
+			return -1;
+
+		const SCRIPTBLOCK_TYPE type = CScriptObj::GetScriptBlockType( s.GetKey() );
+		if ( (type == SCRIPTBLOCK_ELSE) || (type == SCRIPTBLOCK_END) )
+		{
+			endContext = lineContext;
+			return type;
+		}
+
+		CScriptLineContext blockEnd;
+		if ( type == SCRIPTBLOCK_IF )
+		{
+			int iBranchEnd;
+			do
+			{
+				iBranchEnd = SkipBlockByLines( s, blockEnd );
+			} while ( iBranchEnd == SCRIPTBLOCK_ELSE );
+			if ( iBranchEnd < 0 )
+				return -1;
+		}
+		else if ( type == SCRIPTBLOCK_OPEN )
+		{
+			if ( SkipBlockByLines( s, blockEnd ) < 0 )
+				return -1;
+		}
+	}
+}
+#endif
+
 TRIGRET_TYPE CScriptObj::OnTriggerRun( CScript &s, TRIGRUN_TYPE trigrun, CTextConsole * pSrc, CScriptTriggerArgs * pArgs, CSString * pResult )
 {
 	ADDTOCALLSTACK("CScriptObj::OnTriggerRun");
@@ -2778,11 +2944,34 @@ TRIGRET_TYPE CScriptObj::OnTriggerRun( CScript &s, TRIGRUN_TYPE trigrun, CTextCo
         argsEmpty = std::make_unique<CScriptTriggerArgs>();
 		pArgs = argsEmpty.get();
     }
+	// The LOCALs and ARGVs written with a literal name or index in the section are bound when it's scanned.
+	CScriptTriggerArgs::RunScope argsRunScope( *pArgs, s );
 
 	//	Script execution is always not threaded action
 	EXC_TRY("TriggerRun");
 
 	bool fSectionFalse = (trigrun == TRIGRUN_SECTION_FALSE || trigrun == TRIGRUN_SINGLE_FALSE);
+	if ( trigrun == TRIGRUN_SECTION_FALSE )
+	{
+		// The blocks of linked sections are matched at load time: go straight to the line closing this one.
+		EXC_SET_BLOCK("skip block");
+		const CResourceLock * pLock = dynamic_cast<const CResourceLock *>(&s);
+		const CResourceLink * pLink = pLock ? pLock->GetLink() : nullptr;
+		if ( pLink )
+		{
+			const CScriptLineContext * pBlockEnd = pLink->FindBlockEnd( s.GetContext().m_iOffset );
+			if ( pBlockEnd )
+			{
+#ifdef _DEBUG
+				// The jump must land where reading the block line by line would stop.
+				CScriptLineContext walkEnd;
+				const int iWalkEnd = SkipBlockByLines( s, walkEnd );
+				ASSERT( (iWalkEnd >= 0) && (walkEnd.m_iOffset == pBlockEnd->m_iOffset) && (walkEnd.m_iLineNum == pBlockEnd->m_iLineNum) );
+#endif
+				s.SeekContext( *pBlockEnd );
+			}
+		}
+	}
 	if ( trigrun == TRIGRUN_SECTION_EXEC || trigrun == TRIGRUN_SINGLE_EXEC )	// header was already read in.
 		goto jump_in;
 
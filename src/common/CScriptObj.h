@@ -30,6 +30,15 @@ enum TRIGRUN_TYPE
 	TRIGRUN_SINGLE_FALSE	// ignore just this line or blocked segment.
 };
 
+enum SCRIPTBLOCK_TYPE	// what a script line means for the block structure, when skipping it.
+{
+	SCRIPTBLOCK_NONE,		// plain statement.
+	SCRIPTBLOCK_IF,			// IF, skipped up to its ENDIF (through the ELSE/ELIF branches).
+	SCRIPTBLOCK_OPEN,		// BEGIN, loops, DORAND, DOSWITCH: skipped up to the next line closing a block.
+	SCRIPTBLOCK_ELSE,		// ELSE, ELIF, ELSEIF: closes the current branch.
+	SCRIPTBLOCK_END			// END, ENDIF, ENDWHILE...
+};
+
 enum TRIGRET_TYPE	// trigger script returns.
 {
 	TRIGRET_RET_FALSE = 0,	// default return. (script might not have been handled)
@@ -122,6 +131,7 @@ public:
 
 // Generic section parsing
 	virtual TRIGRET_TYPE OnTrigger(lpctstr pszTrigName, CTextConsole* pSrc, CScriptTriggerArgs* pArgs = nullptr);
+	static SCRIPTBLOCK_TYPE GetScriptBlockType(lpctstr ptcKey);
 	bool OnTriggerFind(CScript& s, lpctstr pszTrigName);
 	TRIGRET_TYPE OnTriggerScript(CScript& s, lpctstr pszTrigName, CTextConsole* pSrc, CScriptTriggerArgs* pArgs = nullptr);
 	TRIGRET_TYPE OnTriggerRun(CScript& s, TRIGRUN_TYPE trigger, CTextConsole* pSrc, CScriptTriggerArgs* pArgs, CSString* pReturn);
@@ -2,40 +2,134 @@
 #include "CLog.h"
 #include "CException.h"
 #include "CExpression.h"
+#include "resource/CResourceLink.h"
+#include "resource/CResourceLock.h"
 #include "CScriptTriggerArgs.h"
 
 
+// The string buffers are allocated only when ARGS/ARGV are set: most of the triggers don't use them.
+
 CScriptTriggerArgs::CScriptTriggerArgs() :
-    m_iN1(0), m_iN2(0), m_iN3(0)
+    m_iN1(0), m_iN2(0), m_iN3(0), m_s1(false), m_s1_buf_vec(false)
 {
     m_pO1 = nullptr;
 }
 
-CScriptTriggerArgs::CScriptTriggerArgs(lpctstr pszStr)
+CScriptTriggerArgs::CScriptTriggerArgs(lpctstr pszStr) :
+    m_s1(false), m_s1_buf_vec(false)
 {
     Init(pszStr);
 }
 
 CScriptTriggerArgs::CScriptTriggerArgs(CScriptObj* pObj) :
-    m_iN1(0), m_iN2(0), m_iN3(0), m_pO1(pObj)
+    m_iN1(0), m_iN2(0), m_iN3(0), m_pO1(pObj), m_s1(false), m_s1_buf_vec(false)
 {
 }
 
 CScriptTriggerArgs::CScriptTriggerArgs(int64 iVal1) :
-    m_iN1(iVal1), m_iN2(0), m_iN3(0)
+    m_iN1(iVal1), m_iN2(0), m_iN3(0), m_s1(false), m_s1_buf_vec(false)
 {
     m_pO1 = nullptr;
 }
 
 CScriptTriggerArgs::CScriptTriggerArgs(int64 iVal1, int64 iVal2, int64 iVal3) :
-    m_iN1(iVal1), m_iN2(iVal2), m_iN3(iVal3)
+    m_iN1(iVal1), m_iN2(iVal2), m_iN3(iVal3), m_s1(false), m_s1_buf_vec(false)
 {
     m_pO1 = nullptr;
 }
 
 CScriptTriggerArgs::CScriptTriggerArgs(int64 iVal1, int64 iVal2, CScriptObj* pObj) :
-    m_iN1(iVal1), m_iN2(iVal2), m_iN3(0), m_pO1(pObj)
+    m_iN1(iVal1), m_iN2(iVal2), m_iN3(0), m_pO1(pObj), m_s1(false), m_s1_buf_vec(false)
+{
+}
+
+CScriptTriggerArgs::RunScope::RunScope( CScriptTriggerArgs & args, const CScript & s ) :
+    m_Args(args), m_pPrevScript(args.m_pRunScript), m_pPrevLink(args.m_pRunLink)
+{
+    if ( args.m_pRunScript == &s )
+        return;     // a block of the section already running
+
+    const CResourceLock * pLock = dynamic_cast<const CResourceLock *>(&s);
+    args.m_pRunScript = &s;
+    args.m_pRunLink = pLock ? pLock->GetLink() : nullptr;
+}
+
+CScriptTriggerArgs::RunScope::~RunScope() noexcept
+{
+    m_Args.m_pRunScript = m_pPrevScript;
+    m_Args.m_pRunLink = m_pPrevLink;
+}
+
+CVarDefCont ** CScriptTriggerArgs::GetLocalSlot( lpctstr ptcName )
 {
+    // No ADDTOCALLSTACK: called for each LOCAL read or set.
+    // RETURN: the slot of the frame bound to the LOCAL in the line being run, nullptr if the line doesn't have it with a literal name.
+    if ( m_pRunLink == nullptr )
+        return nullptr;
+    const CResourceLink::LineBinds * pLineBinds = m_pRunLink->FindLineBinds( m_pRunScript->m_iLineNum );
+    if ( pLineBinds == nullptr )
+        return nullptr;
+    const CResourceLink::ArgsBind * pBind = pLineBinds->Find( ptcName, false );
+    if ( pBind == nullptr )
+        return nullptr;
+
+    if ( (m_uiFrame != pLineBinds->m_uiFrame) || (m_uiFrameRemovals != m_VarsLocal.GetRemovals()) )
+    {
+        // Another trigger or function ran with these args, or some LOCALs have been deleted: find them again.
+        std::fill( std::begin(m_apLocalSlots), std::end(m_apLocalSlots), nullptr );
+        m_uiFrame = pLineBinds->m_uiFrame;
+        m_uiFrameRemovals = m_VarsLocal.GetRemovals();
+    }
+    return &m_apLocalSlots[pBind->m_uiSlot];
+}
+
+bool CScriptTriggerArgs::GetArgvIndex( lpctstr ptcIndex, uint * puiIndex ) const
+{
+    // ARGV[n] with a literal index in the line being run: its index was read when the section was scanned.
+    if ( m_pRunLink == nullptr )
+        return false;
+    const CResourceLink::LineBinds * pLineBinds = m_pRunLink->FindLineBinds( m_pRunScript->m_iLineNum );
+    if ( pLineBinds == nullptr )
+        return false;
+    const CResourceLink::ArgsBind * pBind = pLineBinds->Find( ptcIndex, true );
+    if ( pBind == nullptr )
+        return false;
+    *puiIndex = pBind->m_uiSlot;
+    return true;
+}
+
+bool CScriptTriggerArgs::GetLineNative( lpctstr ptcKey, const CScriptNatives::Native_s ** ppNative ) const
+{
+    // No ADDTOCALLSTACK: called for each <...> of the scripts running with args.
+    if ( m_pRunLink == nullptr )
+        return false;
+    const CResourceLink::LineBinds * pLineBinds = m_pRunLink->FindLineBinds( m_pRunScript->m_iLineNum );
+    *ppNative = (pLineBinds == nullptr) ? nullptr : pLineBinds->FindNative( ptcKey );
+    return true;
+}
+
+bool CScriptTriggerArgs::IsArgsKey(lpctstr ptcKey) noexcept // static
+{
+    // No ADDTOCALLSTACK: called for each <...> of the scripts running with args.
+    if ( !strnicmp("LOCAL.", ptcKey, 6) )
+        return !IsSetEF( EF_Intrinsic_Locals );
+    if ( !strnicmp("FLOAT.", ptcKey, 6) )
+        return true;
+    if ( strnicmp("ARG", ptcKey, 3) )
+        return false;
+
+    switch ( toupper(ptcKey[3]) )
+    {
+        case 'N':
+        case 'O':
+        case 'S':
+        case 'V':
+            break;
+        default:
+            return false;
+    }
+    // ARGN1, ARGO.NAME, ARGV[0]... but not ARGSOMETHING.
+    return !_ISCSYMF(ptcKey[4]);
 }
 
 void CScriptTriggerArgs::Clear()
@@ -243,7 +337,14 @@ bool CScriptTriggerArgs::r_Verb( CScript & s, CTextConsole * pSrc )
     {
         bool fQuoted = false;
         lpctstr ptcArg = s.GetArgStr(&fQuoted);
-        m_VarsLocal.SetStr( s.GetKey() + 6, fQuoted, ptcArg, false); // don't change fZero to true! it would break some scripts!
+        lpctstr ptcName = s.GetKey() + 6;
+        CVarDefCont ** ppSlot = GetLocalSlot( ptcName );
+        if ( (ppSlot != nullptr) && (*ppSlot != nullptr) && CVarDefMap::SetValKeepType( *ppSlot, fQuoted, ptcArg ) )
+            return true;
+
+        CVarDefCont * pVar = m_VarsLocal.SetStr( ptcName, fQuoted, ptcArg, false); // don't change fZero to true! it would break some scripts!
+        if ( (ppSlot != nullptr) && (m_uiFrameRemovals == m_VarsLocal.GetRemovals()) )
+            *ppSlot = pVar;
         return true;
 
     }
@@ -393,7 +494,19 @@ bool CScriptTriggerArgs::r_WriteVal( lpctstr ptcKey, CSString &sVal, CTextConsol
     {
         EXC_SET_BLOCK("local");
         ptcKey	+= 6;
-        sVal = m_VarsLocal.GetKeyStr(ptcKey, true);
+        CVarDefCont ** ppSlot = GetLocalSlot( ptcKey );
+        const CVarDefCont * pVar;
+        if ( ppSlot != nullptr )
+        {
+            if ( *ppSlot == nullptr )
+                *ppSlot = m_VarsLocal.GetKey( ptcKey );
+            pVar = *ppSlot;
+        }
+        else
+        {
+            pVar = m_VarsLocal.GetKey( ptcKey );
+        }
+        sVal = CVarDefCont::GetValStrZeroed( pVar, true );
         return true;
     }
 
@@ -512,8 +625,12 @@ bool CScriptTriggerArgs::r_WriteVal( lpctstr ptcKey, CSString &sVal, CTextConsol
             return true;
         }
 
-        SKIP_SEPARATORS(ptcKey);
-        uint uiNum = Exp_GetUSingle(ptcKey);
+        uint uiNum;
+        if ( !GetArgvIndex(ptcKey, &uiNum) )
+        {
+            SKIP_SEPARATORS(ptcKey);
+            uiNum = Exp_GetUSingle(ptcKey);
+        }
         if ( uiNum >= m_v.size() )
         {
             sVal = "";
@@ -5,16 +5,33 @@
 #ifndef _INC_CSCRIPTTRIGGERARGS_H
 #define _INC_CSCRIPTTRIGGERARGS_H
 
+#include "CScriptNatives.h"
 #include "CScriptObj.h"
 #include "CVarDefMap.h"
 #include "CLocalVarsExtra.h"
 #include <vector>
 
+class CResourceLink;
+
 class CScriptTriggerArgs : public CScriptObj
 {
     // All the args an event will need.
     static lpctstr const sm_szLoadKeys[];
 
+public:
+    static constexpr uint kuiLocalSlots = 16;   // LOCALs of a trigger or function with a slot in the frame, see CResourceLink::ScanSection
+
+private:
+    // The section being run with these args, set by OnTriggerRun (RunScope).
+    const CScript * m_pRunScript = nullptr;
+    const CResourceLink * m_pRunLink = nullptr;     // nullptr if the script isn't a scanned section
+
+    // The LOCALs written with a literal name in the scripts are bound to a slot of the frame of their trigger or function
+    //  when the section is scanned: the frame keeps the entries of m_VarsLocal they refer to, found by name only once.
+    uint m_uiFrame = 0;                             // the trigger or function the slots are for, 0 = none
+    uint m_uiFrameRemovals = 0;                     // m_VarsLocal.GetRemovals() when the slots were filled
+    CVarDefCont * m_apLocalSlots[kuiLocalSlots];    // valid only for m_uiFrame
+
 public:
     static const char *m_sClassName;
     int64                   m_iN1;      // "ARGN" or "ARGN1" = a modifying numeric arg to the current trigger.
@@ -29,7 +46,7 @@ public:
 
     std::vector<lpctstr>	m_v;
 
-    CVarDefMap 				m_VarsLocal;    // "LOCAL.x" = local variable x
+    CVarDefMap 				m_VarsLocal{ false };   // "LOCAL.x" = local variable x. Private keys: no lock on the atom table at each trigger call
     CLocalFloatVars			m_VarsFloat;    // "FLOAT.x" = float local variable x
     CLocalObjMap			m_VarObjs;      // "REFx" = local object x
 
@@ -53,6 +70,36 @@ public:
 
     void Clear();
     void Init( lpctstr pszStr );
+
+    class RunScope
+    {
+        // Set the section being run with the args, restore the previous one when done.
+        CScriptTriggerArgs & m_Args;
+        const CScript * m_pPrevScript;
+        const CResourceLink * m_pPrevLink;
+
+    public:
+        RunScope( CScriptTriggerArgs & args, const CScript & s );
+        ~RunScope() noexcept;
+
+    private:
+        RunScope(const RunScope& copy);
+        RunScope& operator=(const RunScope& other);
+    };
+
+private:
+    CVarDefCont ** GetLocalSlot( lpctstr ptcName );
+    bool GetArgvIndex( lpctstr ptcIndex, uint * puiIndex ) const;
+
+public:
+    // The natives called by the line being run were found when its section was scanned.
+    // RETURN: false = the script isn't a scanned section. *ppNative = nullptr if the line doesn't call a native with ptcKey.
+    bool GetLineNative( lpctstr ptcKey, const CScriptNatives::Native_s ** ppNative ) const;
+
+    // The key is a LOCAL/FLOAT variable or an ARGN/ARGS/ARGV/ARGO: only the args can resolve it,
+    //  so there's no need to look for it in the properties of the object running the script first.
+    static bool IsArgsKey(lpctstr ptcKey) noexcept;
+
     bool r_Verb( CScript & s, CTextConsole * pSrc ) override;
     bool r_LoadVal( CScript & s ) override;
     bool r_GetRef( lpctstr & ptcKey, CScriptObj * & pRef ) override;
@@ -32,7 +32,11 @@ lpctstr CVarDefCont::GetValStrZeroed(const CVarDefCont* pVar, bool fZero) // sta
 *
 ***************************************************************************/
 
-CVarDefContNum::CVarDefContNum( lpctstr ptcKey, int64 iVal ) : m_sKey( ptcKey ), m_iVal( iVal )
+CVarDefContNum::CVarDefContNum( lpctstr ptcKey, int64 iVal, bool fSharedKey ) : m_sKey( ptcKey, fSharedKey ), m_iVal( iVal )
+{
+}
+
+CVarDefContNum::CVarDefContNum( const CSAtomRef& sKey, int64 iVal ) : m_sKey( sKey ), m_iVal( iVal )
 {
 }
 
@@ -61,7 +65,7 @@ bool CVarDefContNum::r_WriteVal( lpctstr pKey, CSString & sVal, CTextConsole * p
 
 CVarDefCont * CVarDefContNum::CopySelf() const
 { 
-	return new CVarDefContNum( GetKey(), m_iVal );
+	return new CVarDefContNum( m_sKey, m_iVal );
 }
 
 /***************************************************************************
@@ -72,7 +76,11 @@ CVarDefCont * CVarDefContNum::CopySelf() const
 *
 ***************************************************************************/
 
-CVarDefContStr::CVarDefContStr( lpctstr ptcKey, lpctstr pszVal ) : m_sKey( ptcKey ), m_sVal( pszVal ) 
+CVarDefContStr::CVarDefContStr( lpctstr ptcKey, lpctstr pszVal, bool fSharedKey ) : m_sKey( ptcKey, fSharedKey ), m_sVal( pszVal ) 
+{
+}
+
+CVarDefContStr::CVarDefContStr( const CSAtomRef& sKey, const CSString& sVal ) : m_sKey( sKey ), m_sVal( sVal )
 {
 }
 
@@ -111,7 +119,7 @@ bool CVarDefContStr::r_WriteVal( lpctstr pKey, CSString & sVal, CTextConsole * p
 
 CVarDefCont * CVarDefContStr::CopySelf() const 
 { 
-	return new CVarDefContStr( GetKey(), m_sVal ); 
+	return new CVarDefContStr( m_sKey, m_sVal ); 
 }
 
 
@@ -180,6 +188,12 @@ CVarDefCont * CVarDefMap::GetAt( size_t at ) const
 CVarDefCont * CVarDefMap::GetAtKey( lpctstr ptcKey ) const
 {
 	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::GetAtKey");
+    if (!m_Index.empty())
+    {
+        const auto it = m_Index.find(std::string_view(ptcKey));
+        return (it == m_Index.end()) ? nullptr : it->second;
+    }
+
     const size_t idx = m_Container.find_predicate(ptcKey, VarDefCompare);
 
 	if ( idx != SCONT_BADINDEX )
@@ -195,9 +209,12 @@ void CVarDefMap::DeleteAt( size_t at )
 
     CVarDefCont *pVarBase = m_Container[at];
     m_Container.erase(m_Container.begin() + at);
+    ++m_uiRemovals;
 
     if ( pVarBase )
     {
+        IndexRemove(pVarBase);
+
         CVarDefContNum *pVarNum = dynamic_cast<CVarDefContNum *>(pVarBase);
         if ( pVarNum )
         {
@@ -215,6 +232,9 @@ void CVarDefMap::DeleteAt( size_t at )
 void CVarDefMap::DeleteAtKey( lpctstr ptcKey )
 {
 	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::DeleteAtKey");
+    if (!m_Index.empty() && !GetAtKey(ptcKey))
+        return;     // most of the times the key isn't there (TAG.X=0 and similar)
+
     const size_t idx = m_Container.find_predicate(ptcKey, VarDefCompare);
     if (idx != SCONT_BADINDEX)
         DeleteAt(idx);
@@ -227,18 +247,51 @@ void CVarDefMap::DeleteKey( lpctstr key )
 		DeleteAtKey(key);
 }
 
+void CVarDefMap::IndexAdd( CVarDefCont * pVar )
+{
+	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::IndexAdd");
+    // pVar has just been added to m_Container.
+    if (m_Index.empty())
+    {
+        if (m_Container.size() < kuiIndexMinCount)
+            return;
+
+        // The map has grown enough, index all of it.
+        m_Index.reserve(m_Container.size());
+        for (CVarDefCont* pCont : m_Container)
+            m_Index.try_emplace(std::string_view(pCont->GetKey()), pCont);
+        return;
+    }
+    m_Index.try_emplace(std::string_view(pVar->GetKey()), pVar);
+}
+
+void CVarDefMap::IndexRemove( const CVarDefCont * pVar )
+{
+	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::IndexRemove");
+    // pVar has just been removed from m_Container.
+    if (m_Index.empty())
+        return;
+
+    const auto it = m_Index.find(std::string_view(pVar->GetKey()));
+    if ((it == m_Index.end()) || (it->second != pVar))
+        return;
+    m_Index.erase(it);
+
+    // SetNumNew and SetStrNew don't check if the key is already there: index the other one, if any.
+    const size_t idx = m_Container.find_predicate(pVar->GetKey(), VarDefCompare);
+    if (idx != SCONT_BADINDEX)
+        m_Index.try_emplace(std::string_view(m_Container[idx]->GetKey()), m_Container[idx]);
+}
+
 void CVarDefMap::Clear()
 {
 	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::Empty");
-	iterator it = m_Container.begin();
-	while ( it != m_Container.end() )
-	{
-		delete (*it);	// This calls the appropriate destructors, from derived to base class, because the destructors are virtual.
-		m_Container.erase(it);
-		it = m_Container.begin();
-	}
+    for (CVarDefCont* pVar : m_Container)
+		delete pVar;	// This calls the appropriate destructors, from derived to base class, because the destructors are virtual.
 
 	m_Container.clear();
+    m_Index.clear();
+    ++m_uiRemovals;
 }
 
 void CVarDefMap::Copy( const CVarDefMap * pArray )
@@ -253,7 +306,9 @@ void CVarDefMap::Copy( const CVarDefMap * pArray )
 
     for (const CVarDefCont* pVar : pArray->m_Container)
 	{
-		m_Container.insert( pVar->CopySelf() );
+        CVarDefCont* pVarCopy = pVar->CopySelf();
+		m_Container.insert( pVarCopy );
+        IndexAdd( pVarCopy );
 	}
 }
 
@@ -322,13 +377,16 @@ size_t CVarDefMap::GetCount() const
 CVarDefContNum* CVarDefMap::SetNumNew( lpctstr pszName, int64 iVal )
 {
 	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::SetNumNew");
-	CVarDefContNum * pVarNum = new CVarDefContNum( pszName, iVal );
+	CVarDefContNum * pVarNum = new CVarDefContNum( pszName, iVal, m_fSharedKeys );
 	if ( !pVarNum )
 		return nullptr;
 
 	iterator res = m_Container.emplace(static_cast<CVarDefCont*>(pVarNum));
 	if ( res != m_Container.end() )
+    {
+        IndexAdd(pVarNum);
 		return pVarNum;
+    }
 	else
     {
         delete pVarNum;
@@ -388,11 +446,7 @@ CVarDefContNum* CVarDefMap::SetNum( lpctstr pszName, int64 iVal, bool fDeleteZer
 		return nullptr;
 	}
 
-    const size_t idx = m_Container.find_predicate(pszName, VarDefCompare);
-
-	CVarDefCont * pVarBase = nullptr;
-	if ( idx != SCONT_BADINDEX )
-		pVarBase = m_Container[idx];
+	CVarDefCont * pVarBase = GetAtKey(pszName);
 
 	if ( !pVarBase )
 		return SetNumNew( pszName, iVal );
@@ -417,13 +471,16 @@ CVarDefContNum* CVarDefMap::SetNum( lpctstr pszName, int64 iVal, bool fDeleteZer
 CVarDefContStr* CVarDefMap::SetStrNew( lpctstr pszName, lpctstr pszVal )
 {
 	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::SetStrNew");
-	CVarDefContStr * pVarStr = new CVarDefContStr( pszName, pszVal );
+	CVarDefContStr * pVarStr = new CVarDefContStr( pszName, pszVal, m_fSharedKeys );
 	if ( !pVarStr )
 		return nullptr;
 
     iterator res = m_Container.emplace(static_cast<CVarDefCont*>(pVarStr));
     if ( res != m_Container.end() )
+    {
+        IndexAdd(pVarStr);
 		return pVarStr;
+    }
 	else
     {
         delete pVarStr;
@@ -469,11 +526,7 @@ CVarDefCont* CVarDefMap::SetStr( lpctstr pszName, bool fQuoted, lpctstr pszVal,
 		}
 	}
 
-    const size_t idx = m_Container.find_predicate(pszName, VarDefCompare);
-
-	CVarDefCont * pVarBase = nullptr;
-	if ( idx != SCONT_BADINDEX )
-		pVarBase = m_Container[idx];
+	CVarDefCont * pVarBase = GetAtKey(pszName);
 
 	if ( !pVarBase )
 		return SetStrNew( pszName, pszVal );
@@ -494,18 +547,45 @@ CVarDefCont* CVarDefMap::SetStr( lpctstr pszName, bool fQuoted, lpctstr pszVal,
 	return pVarStr;
 }
 
+bool CVarDefMap::SetValKeepType( CVarDefCont * pVar, bool fQuoted, lpctstr pszVal ) // static
+{
+	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::SetValKeepType");
+	// Set the value of an entry of the map as SetStr (with fDeleteZero = false) would, when it doesn't have to delete it or change its type.
+	// RETURN: false = the value wasn't set, call SetStr.
+	ASSERT(pVar);
+	ASSERT(pszVal);
+	if ( g_Serv.IsLoading() && !g_Serv.IsResyncing() )
+		return false;	// let SetStr warn about the overwrite
+
+	if ( !fQuoted )
+	{
+		if ( pszVal[0] == '\0' )
+			return false;
+
+		if ( IsSimpleNumberString(pszVal) )
+		{
+			CVarDefContNum * pVarNum = dynamic_cast<CVarDefContNum *>( pVar );
+			if ( !pVarNum )
+				return false;
+			pVarNum->SetValNum( Exp_Get64Val(pszVal) );
+			return true;
+		}
+	}
+
+	CVarDefContStr * pVarStr = dynamic_cast<CVarDefContStr *>( pVar );
+	if ( !pVarStr )
+		return false;
+	pVarStr->SetValStr( pszVal );
+	return true;
+}
+
 CVarDefCont * CVarDefMap::GetKey( lpctstr ptcKey ) const
 {
 	ADDTOCALLSTACK_INTENSIVE("CVarDefMap::GetKey");
 	CVarDefCont * pReturn = nullptr;
 
 	if ( ptcKey )
-	{
-        const size_t idx = m_Container.find_predicate(ptcKey, VarDefCompare);
-		
-		if ( idx != SCONT_BADINDEX )
-			pReturn = m_Container[idx];
-	}
+		pReturn = GetAtKey(ptcKey);
 
 	return pReturn;
 }
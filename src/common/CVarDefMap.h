@@ -6,6 +6,8 @@
 #ifndef _INC_CVARDEFMAP_H
 #define _INC_CVARDEFMAP_H
 
+#include "parallel_hashmap/phmap.h"
+#include "sphere_library/CSAtom.h"
 #include "sphere_library/CSString.h"
 #include "sphere_library/CSSortedVector.h"
 
@@ -39,17 +41,18 @@ public:
 class CVarDefContNum : public CVarDefCont
 {
 private:
-    CSString m_sKey;    // reference to map key
+    CSAtomRef m_sKey;   // reference to map key
 	int64 m_iVal;       // the assigned value
 
 public:
 	static const char *m_sClassName;
 
-	CVarDefContNum( lpctstr ptcKey, int64 iVal );
+	CVarDefContNum( lpctstr ptcKey, int64 iVal, bool fSharedKey = true );
 	CVarDefContNum( lpctstr ptcKey );
 	virtual ~CVarDefContNum() = default;
 
 private:
+	CVarDefContNum( const CSAtomRef& sKey, int64 iVal );	// CopySelf: shares the key without looking for it again
 	CVarDefContNum(const CVarDefContNum& copy);
 	CVarDefContNum& operator=(const CVarDefContNum& other);
 
@@ -77,17 +80,18 @@ public:
 class CVarDefContStr : public CVarDefCont
 {
 private:
-    CSString m_sKey;    // map key
+    CSAtomRef m_sKey;   // map key
 	CSString m_sVal;    // the assigned value
 
 public:
 	static const char *m_sClassName;
 
-	CVarDefContStr( lpctstr ptcKey, lpctstr pszVal );
+	CVarDefContStr( lpctstr ptcKey, lpctstr pszVal, bool fSharedKey = true );
 	explicit CVarDefContStr( lpctstr ptcKey );
 	virtual ~CVarDefContStr() = default;
 
 private:
+	CVarDefContStr( const CSAtomRef& sKey, const CSString& sVal );	// CopySelf: shares the key without looking for it again
 	CVarDefContStr(const CVarDefContStr& copy);
 	CVarDefContStr& operator=(const CVarDefContStr& other);
 
@@ -121,11 +125,18 @@ class CVarDefMap
         }
 	};
 	using DefCont = CSSortedVector<CVarDefCont *, ltstr>;
+    using DefIndex = phmap::flat_hash_map<std::string_view, CVarDefCont *, StrViewHashI_s, StrViewEqualI_s>;
 
-	DefCont m_Container;
+	DefCont m_Container;    // sorted by key, it gives the iteration order (dumps, saves)
+    DefIndex m_Index;       // keys of m_Container, to find them without the binary search. Empty until m_Container reaches kuiIndexMinCount elements.
+    bool m_fSharedKeys;     // false: the keys don't go in the global atom table (LOCALs, created and destroyed at each trigger call).
+                            // The atoms only share the storage of the keys, which are still found by text. Only adding a key goes through the table, setting an existing one doesn't.
+    uint m_uiRemovals;      // bumped when entries are deleted: pointers to the entries kept outside of the map are valid as long as it doesn't change
 
 public:
 	static const char *m_sClassName;
+    static constexpr size_t kuiIndexMinCount = 32;  // most of the maps (TAGs of a single object, LOCALs) are small, the binary search is fine for them
+
     using iterator          = DefCont::iterator;
     using const_iterator    = DefCont::const_iterator;
 
@@ -133,6 +144,8 @@ private:
 	CVarDefCont * GetAtKey( lpctstr ptcKey ) const;
 	void DeleteAt( size_t at );
 	void DeleteAtKey( lpctstr ptcKey );
+    void IndexAdd( CVarDefCont * pVar );
+    void IndexRemove( const CVarDefCont * pVar );
 
     CVarDefContNum* SetNumOverride( lpctstr ptcKey, int64 iVal );
     CVarDefContStr* SetStrOverride( lpctstr ptcKey, lpctstr pszVal );
@@ -145,7 +158,7 @@ public:
 	size_t GetCount() const;
 
 public:
-	CVarDefMap() = default;
+	explicit CVarDefMap( bool fSharedKeys = true ) : m_fSharedKeys( fSharedKeys ), m_uiRemovals( 0 ) {}
 	~CVarDefMap();
 	CVarDefMap & operator = ( const CVarDefMap & array );
 
@@ -162,6 +175,10 @@ public:
     CVarDefContStr* SetStrNew( lpctstr ptcKey, lpctstr pszVal );
     CVarDefCont* SetStr( lpctstr ptcKey, bool fQuoted, lpctstr pszVal, bool fDeleteZero = true, bool fWarnOverwrite = true );
 
+	static bool SetValKeepType( CVarDefCont * pVar, bool fQuoted, lpctstr pszVal );
+	inline uint GetRemovals() const noexcept {
+        return m_uiRemovals;
+    }
 	CVarDefCont * GetAt( size_t at ) const;
 	CVarDefCont * GetKey( lpctstr ptcKey ) const;
     inline CVarDefContNum * GetKeyDefNum( lpctstr ptcKey ) const;
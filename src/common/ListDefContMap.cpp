@@ -16,11 +16,11 @@
 *
 *
 ***************************************************************************/
-CListDefContNum::CListDefContNum( lpctstr ptcKey, int64 iVal ) : CListDefContElem( ptcKey ), m_iVal( iVal )
+CListDefContNum::CListDefContNum( const CSAtomRef& sKey, int64 iVal ) : CListDefContElem( sKey ), m_iVal( iVal )
 {
 }
 
-CListDefContNum::CListDefContNum( lpctstr ptcKey ) : CListDefContElem( ptcKey ), m_iVal( 0 )
+CListDefContNum::CListDefContNum( const CSAtomRef& sKey ) : CListDefContElem( sKey ), m_iVal( 0 )
 {
 }
 
@@ -45,7 +45,7 @@ bool CListDefContNum::r_WriteVal( lpctstr pKey, CSString & sVal, CTextConsole *
 
 CListDefContElem * CListDefContNum::CopySelf() const
 { 
-	return new CListDefContNum( GetKey(), m_iVal );
+	return new CListDefContNum( GetKeyAtom(), m_iVal );
 }
 
 /***************************************************************************
@@ -55,11 +55,11 @@ CListDefContElem * CListDefContNum::CopySelf() const
 *
 *
 ***************************************************************************/
-CListDefContStr::CListDefContStr( lpctstr ptcKey, lpctstr pszVal ) : CListDefContElem( ptcKey ), m_sVal( pszVal ) 
+CListDefContStr::CListDefContStr( const CSAtomRef& sKey, lpctstr pszVal ) : CListDefContElem( sKey ), m_sVal( pszVal ) 
 {
 }
 
-CListDefContStr::CListDefContStr( lpctstr ptcKey ) : CListDefContElem( ptcKey )
+CListDefContStr::CListDefContStr( const CSAtomRef& sKey ) : CListDefContElem( sKey )
 {
 }
 
@@ -91,7 +91,7 @@ bool CListDefContStr::r_WriteVal( lpctstr pKey, CSString & sVal, CTextConsole *
 
 CListDefContElem * CListDefContStr::CopySelf() const 
 { 
-	return new CListDefContStr( GetKey(), m_sVal ); 
+	return new CListDefContStr( GetKeyAtom(), m_sVal ); 
 }
 
 /***************************************************************************
@@ -101,7 +101,7 @@ CListDefContElem * CListDefContStr::CopySelf() const
 *
 *
 ***************************************************************************/
-CListDefCont::CListDefCont( lpctstr ptcKey ) : m_Key( ptcKey ) 
+CListDefCont::CListDefCont( const CSAtomRef& sKey ) : m_Key( sKey ) 
 { 
 }
 
@@ -135,7 +135,7 @@ bool CListDefCont::SetNumAt(size_t nIndex, int64 iVal)
 	if ( !pListElem )
 		return false;
 
-	CListDefContElem* pListNewElem = new CListDefContNum(m_Key.GetBuffer(), iVal);
+	CListDefContElem* pListNewElem = new CListDefContNum(m_Key, iVal);
 
     DefList::iterator it = m_listElements.begin();
     std::advance(it, nIndex);
@@ -153,7 +153,7 @@ bool CListDefCont::SetStrAt(size_t nIndex, lpctstr pszVal)
 	if ( !pListElem )
 		return false;
 
-	CListDefContElem* pListNewElem = new CListDefContStr(m_Key.GetBuffer(), pszVal);
+	CListDefContElem* pListNewElem = new CListDefContStr(m_Key, pszVal);
 
     DefList::iterator it = m_listElements.begin();
     std::advance(it, nIndex);
@@ -242,7 +242,7 @@ bool CListDefCont::AddElementNum(int64 iVal)
 	if ( (m_listElements.size() + 1) >= INTPTR_MAX )	// overflow? is it even useful?
 		return false;
 
-	m_listElements.emplace_back( new CListDefContNum(m_Key.GetBuffer(), iVal) );
+	m_listElements.emplace_back( new CListDefContNum(m_Key, iVal) );
 
 	return true;
 }
@@ -255,7 +255,7 @@ bool CListDefCont::AddElementStr(lpctstr ptcKey)
 
 	REMOVE_QUOTES( ptcKey );
 
-	m_listElements.emplace_back( new CListDefContStr(m_Key.GetBuffer(), ptcKey) );
+	m_listElements.emplace_back( new CListDefContStr(m_Key, ptcKey) );
 
 	return true;
 }
@@ -403,7 +403,7 @@ bool CListDefCont::InsertElementNum(size_t nIndex, int64 iVal)
     if (it == m_listElements.end())
         return false;
 
-    m_listElements.insert(it, new CListDefContNum(m_Key.GetBuffer(), iVal));
+    m_listElements.insert(it, new CListDefContNum(m_Key, iVal));
     return true;
 
 	return false;
@@ -420,7 +420,7 @@ bool CListDefCont::InsertElementStr(size_t nIndex, lpctstr ptcKey)
     if (it == m_listElements.end())
         return false;
 
-    m_listElements.insert(it, new CListDefContStr(m_Key.GetBuffer(), ptcKey));
+    m_listElements.insert(it, new CListDefContStr(m_Key, ptcKey));
     return true;
 }
 
@@ -430,7 +430,7 @@ CListDefCont* CListDefCont::CopySelf()
     if (m_listElements.empty())
         return nullptr;
 	
-    CListDefCont* pNewList = new CListDefCont(m_Key.GetBuffer());
+    CListDefCont* pNewList = new CListDefCont(m_Key);
 	if ( !pNewList )
         return nullptr;
 
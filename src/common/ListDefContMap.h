@@ -9,6 +9,7 @@
 #include <deque>
 #include <set>
 #include "common.h"
+#include "sphere_library/CSAtom.h"
 #include "sphere_library/CSString.h"
 
 
@@ -18,12 +19,12 @@ class CScript;
 class CListDefContElem
 {
 private:
-	CSString m_Key;	// reference to map key
+	CSAtomRef m_Key;	// reference to map key
 
 public:
 	static const char *m_sClassName;
 
-    explicit CListDefContElem(lpctstr ptcKey) : m_Key(ptcKey) {};
+    explicit CListDefContElem(const CSAtomRef& sKey) : m_Key(sKey) {};	// the elements share the atom of their list's name
 	virtual ~CListDefContElem() = default;
 
 private:
@@ -34,6 +35,9 @@ public:
     inline lpctstr GetKey() const {
         return m_Key.GetBuffer();
     }
+    inline const CSAtomRef& GetKeyAtom() const noexcept {
+        return m_Key;
+    }
     inline void SetKey(lpctstr ptcKey) {
         m_Key = ptcKey;
     }
@@ -52,8 +56,8 @@ private:
 public:
 	static const char *m_sClassName;
 
-	explicit CListDefContNum(lpctstr ptcKey);
-	CListDefContNum(lpctstr ptcKey, int64 iVal);
+	explicit CListDefContNum(const CSAtomRef& sKey);
+	CListDefContNum(const CSAtomRef& sKey, int64 iVal);
 	~CListDefContNum() = default;
 
 private:
@@ -84,8 +88,8 @@ private:
 public:
 	static const char *m_sClassName;
 
-	CListDefContStr(lpctstr ptcKey, lpctstr pszVal);
-	explicit CListDefContStr(lpctstr ptcKey);
+	CListDefContStr(const CSAtomRef& sKey, lpctstr pszVal);
+	explicit CListDefContStr(const CSAtomRef& sKey);
 	~CListDefContStr() = default;
 
 private:
@@ -109,7 +113,7 @@ public:
 class CListDefCont
 {
 private:
-	CSString m_Key;	// reference to map key
+	CSAtomRef m_Key;	// reference to map key
 
 	typedef std::deque<CListDefContElem *> DefList;
 
@@ -121,7 +125,7 @@ protected:
 public:
 	static const char *m_sClassName;
 
-	explicit CListDefCont(lpctstr ptcKey);
+	explicit CListDefCont(const CSAtomRef& sKey);
 	~CListDefCont() = default;
 
 private:
@@ -9,10 +9,10 @@
 #include "../CLog.h"
 #include "CCrypto.h"
 
-// For TwoFish and MD5 we only provide an interface, so we include the headers of the code doing all the related crypto stuff
-#include "twofish/twofish.h"
 #include "CMD5.h"
 
+// The state of the engine, the client keys and the helpers shared with the client side are in CCryptoCore.cpp
+
 
 // ===============================================================================================================
 // ---------------------------------------------------------------------------------------------------------------
@@ -20,73 +20,6 @@
 
 /*		Login keys from SphereCrypt.ini		*/
 
-std::vector<CCryptoClientKey> CCrypto::client_keys;
-
-void CCrypto::SetClientVersion( dword iVer )
-{
-	m_iClientVersion = iVer;
-}
-
-void CCrypto::SetMasterKeys( dword hi, dword low )
-{
-	m_MasterHi = hi;
-	m_MasterLo = low;
-}
-
-void CCrypto::SetCryptMask( dword hi, dword low )
-{
-	m_CryptMaskHi = hi;
-	m_CryptMaskLo= low;
-}
-
-bool CCrypto::SetConnectType( CONNECT_TYPE ctWho )
-{
-	if ( ctWho > CONNECT_NONE && ctWho < CONNECT_QTY )
-	{
-		m_ConnectType = ctWho;
-		return true;
-	}
-
-	return false;
-}
-
-bool CCrypto::SetEncryptionType( ENCRYPTION_TYPE etWho )
-{
-	if ( etWho >= ENC_NONE && etWho < ENC_QTY )
-	{
-		m_GameEnc = etWho;
-		return true;
-	}
-
-	return false;
-}
-
-dword CCrypto::GetClientVer() const
-{
-	return m_iClientVersion;
-}
-
-bool CCrypto::IsValid() const
-{
-	return ( m_iClientVersion > 0 );
-	//return ( (m_iClientVersion > 0) && (m_iClientVersion < 10000000) );	// should be safer? which versions do the Enhanced clients report?
-}
-
-bool CCrypto::IsInit() const
-{
-	return m_fInit;
-}
-
-CONNECT_TYPE CCrypto::GetConnectType() const
-{
-	return m_ConnectType;
-}
-
-ENCRYPTION_TYPE CCrypto::GetEncryptionType() const
-{
-	return m_GameEnc;
-}
-
 void CCrypto::LoadKeyTable(CScript & s)
 {
 	ADDTOCALLSTACK("CCrypto::LoadKeyTable");
@@ -106,17 +39,6 @@ void CCrypto::LoadKeyTable(CScript & s)
 	}
 }
 
-void CCrypto::addNoCryptKey(void)
-{
-	ADDTOCALLSTACK("CCrypto::addNoCryptKey");
-	CCryptoClientKey c;
-	c.m_client = 0;
-	c.m_key_1 = 0;
-	c.m_key_2 = 0;
-	c.m_EncType = ENC_NONE;
-	client_keys.emplace_back(c);
-}
-
 // ---------------------------------------------------------------------------------------------------------------
 // ===============================================================================================================
 // ---------------------------------------------------------------------------------------------------------------
@@ -183,14 +105,6 @@ int CCrypto::GetVerFromString( lpctstr pszVersion )
 	return (atoi(piVer[0]) * 1000000) + (atoi(piVer[1]) * 10000) + (atoi(piVer[2]) * 100) + iLetter;
 }
 
-int CCrypto::GetVerFromNumber( dword maj, dword min, dword rev, dword pat )
-{
-	ADDTOCALLSTACK("CCrypto::GetVerFromNumber");
-	// Get version of new clients (5.0.6.5+), which report the client version as numbers (eg: 5,0,6,5)
-
-	return (maj * 1000000) + (min * 10000) + (rev * 100) + pat;
-}
-
 char* CCrypto::WriteClientVerString( dword iClientVersion, char * pStr, uint uiBufLen)
 {
 	ADDTOCALLSTACK("CCrypto::WriteClientVerString");
@@ -224,48 +138,6 @@ char* CCrypto::WriteClientVer( char * pcStr, uint uiBufLen) const
 	return( CCrypto::WriteClientVerString( GetClientVer(), pcStr, uiBufLen ) );
 }
 
-bool CCrypto::SetClientVerEnum( dword iVer, bool bSetEncrypt )
-{
-	ADDTOCALLSTACK("CCrypto::SetClientVerEnum");
-	for (size_t i = 0; i < client_keys.size(); ++i )
-	{
-		CCryptoClientKey & key = client_keys[i];
-
-		if ( iVer == key.m_client )
-		{
-			if ( SetClientVerIndex( i, bSetEncrypt ))
-				return true;
-		}
-	}
-
-	return false;
-}
-
-bool CCrypto::SetClientVerIndex( size_t iVer, bool bSetEncrypt )
-{
-	ADDTOCALLSTACK("CCrypto::SetClientVerIndex");
-	if ( iVer >= client_keys.size() )
-		return false;
-
-	CCryptoClientKey & key = client_keys[iVer];
-
-	SetClientVersion(key.m_client);
-	SetMasterKeys(key.m_key_1, key.m_key_2); // Hi - Lo
-	if ( bSetEncrypt )
-		SetEncryptionType(key.m_EncType);
-
-	return true;
-}
-
-void CCrypto::SetClientVer( const CCrypto & crypt )
-{
-	ADDTOCALLSTACK("CCrypto::SetClientVer");
-	m_fInit = false;
-	m_iClientVersion = crypt.m_iClientVersion;
-	m_MasterHi = crypt.m_MasterHi;
-	m_MasterLo = crypt.m_MasterLo;
-}
-
 bool CCrypto::SetClientVer( lpctstr pszVersion )
 {
 	ADDTOCALLSTACK("CCrypto::SetClientVer");
@@ -290,38 +162,6 @@ bool CCrypto::SetClientVer( lpctstr pszVersion )
 
 /*		Init encryption engine		*/
 
-CCrypto::CCrypto()
-{
-	// Always at least one crypt code, for non encrypted clients!
-	if ( ! client_keys.size() )
-		addNoCryptKey();
-
-	m_fInit = false;
-	m_fRelayPacket = false;
-	//SetClientVerEnum(client_keys[0][2]);
-	SetClientVerEnum(0);
-
-	tf_cipher	= new cipherInstance;
-	tf_key		= new keyInstance;
-	m_md5_engine	= new CMD5();
-
-	m_CryptMaskHi = m_CryptMaskLo = 0;
-	m_seed = 0;
-	m_ConnectType = CONNECT_NONE;
-	tf_position = 0;
-	m_gameTable = 0;
-	m_gameBlockPos = 0;
-	m_gameStreamPos = 0;
-	m_md5_position = 0;
-}
-
-CCrypto::~CCrypto()
-{
-	delete tf_cipher;
-	delete tf_key;
-	delete m_md5_engine;
-}
-
 bool CCrypto::Init( dword dwIP, const byte * pEvent, uint inLen, bool isclientKr )
 {
 	ADDTOCALLSTACK("CCrypto::Init");
@@ -609,8 +449,8 @@ bool CCrypto::LoginCryptStart( dword dwIP, const byte * pEvent, uint inLen )
 	m_seed = dwIP;
 	SetConnectType( CONNECT_LOGIN );
 
-	dword tmp_CryptMaskLo = (((~m_seed) ^ 0x00001357) << 16) | ((( m_seed) ^ 0xffffaaaa) & 0x0000ffff);
-	dword tmp_CryptMaskHi = ((( m_seed) ^ 0x43210000) >> 16) | (((~m_seed) ^ 0xabcdffff) & 0xffff0000);
+	dword tmp_CryptMaskHi, tmp_CryptMaskLo;
+	GetLoginCryptMask(m_seed, tmp_CryptMaskHi, tmp_CryptMaskLo);
 
 	SetClientVerIndex(0);
 	SetCryptMask(tmp_CryptMaskHi, tmp_CryptMaskLo);
@@ -742,8 +582,8 @@ bool CCrypto::GameCryptStart( dword dwIP, const byte * pEvent, uint inLen )
     // Auto-detect if the encryption is LOGIN (clients < 1.26.0 use as game encryption/decryption the same algorithm used for the login encryption)
     if (!bOut)
     {
-        const dword tmp_CryptMaskLo = (((~m_seed) ^ 0x00001357) << 16) | ((( m_seed) ^ 0xffffaaaa) & 0x0000ffff);
-        const dword tmp_CryptMaskHi = ((( m_seed) ^ 0x43210000) >> 16) | (((~m_seed) ^ 0xabcdffff) & 0xffff0000);
+        dword tmp_CryptMaskHi, tmp_CryptMaskLo;
+        GetLoginCryptMask(m_seed, tmp_CryptMaskHi, tmp_CryptMaskLo);
         SetClientVerIndex(0);
 
         for (size_t i = 0;;)
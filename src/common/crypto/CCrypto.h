@@ -56,6 +56,8 @@ public:
     CHuffman() = default;
 
     static uint Compress(byte* pOutput, const byte* pInput, uint outLen, uint inLen);
+    // Codes of the COMPRESS_TREE_SIZE symbols (the last one ends a packet), the lowest 4 bits are the code length
+    static const word* GetCodes() { return sm_xCompress_Base; }
 
 private:
 	static const word sm_xCompress_Base[COMPRESS_TREE_SIZE];	
@@ -119,6 +121,9 @@ public:
 	//static int GetPacketSize(byte packet);
 	// --------------- EOF Generic -------------------------------
 
+private:
+	static void XorKeystream( byte * pOutput, const byte * pInput, const byte * pKey, size_t uiLen );
+
 protected:
 	// --------------- Two Fish ------------------------------
 	#define TFISH_RESET 0x100
@@ -163,9 +168,11 @@ private:
 protected:
 	// -------------------- MD5 ------------------------------
 	#define MD5_RESET 0x0F
+	#define MD5_KEYSTREAM 0x100
 	CMD5 * m_md5_engine;
 	uint m_md5_position;
 	byte m_md5_digest[16];
+	byte m_md5_keystream[MD5_KEYSTREAM + 16];	// digest repeated, read from any position up to MD5_KEYSTREAM bytes at once
 protected:
 	bool EncryptMD5( byte * pOutput, const byte * pInput, size_t outLen, size_t inLen );
 	void InitMD5(byte * ucInitialize);
@@ -173,6 +180,7 @@ protected:
 
 private:
 	// ------------- Login Encryption ----------------------
+	static void GetLoginCryptMask( dword dwSeed, dword & dwMaskHi, dword & dwMaskLo );
 	bool DecryptLogin( byte * pOutput, const byte * pInput, size_t outLen, size_t inLen );
 	// ------------- EOF Login Encryption ------------------
 
@@ -216,6 +224,13 @@ public:
 	void InitFast( dword dwIP, CONNECT_TYPE ctInit, bool fRelay = true );
 	bool Decrypt( byte * pOutput, const byte * pInput, uint outLen, uint inLen );
 	bool Encrypt( byte * pOutput, const byte * pInput, uint outLen, uint inLen );
+
+// --------- Client side (used by the headless client, see CCryptoClient.cpp)
+public:
+	bool InitClient( dword dwSeed, dword dwClientVer, CONNECT_TYPE ctInit );
+	bool EncryptClient( byte * pOutput, const byte * pInput, uint outLen, uint inLen );
+	bool DecryptClient( byte * pOutput, const byte * pInput, uint outLen, uint inLen );
+
 protected:
 	bool LoginCryptStart( dword dwIP, const  byte * pEvent, uint inLen );
 	bool GameCryptStart( dword dwIP, const byte * pEvent, uint inLen );
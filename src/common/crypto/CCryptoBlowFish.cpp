@@ -98,14 +98,32 @@ bool CCrypto::DecryptBlowFish( byte * pOutput, const byte * pInput, size_t outLe
 		inLen -= lenOld;
 	}
 
-	for ( size_t i = 0; i < inLen; ++i )
-	{
-        if (i >= outLen)
-            return false;
+	const size_t len = minimum(inLen, outLen);
+	size_t i = 0;
 
+	// finish the current block
+	for ( ; (i < len) && (m_gameBlockPos != 0); ++i )
 		pOutput[i] = DecryptBFByte( pInput[i] );
+
+	// whole blocks: the key of a block only depends on the previous encrypted block, so
+	// it is prepared once and applied to the 8 bytes without further checks
+	for ( ; (i + 8) <= len; i += 8 )
+	{
+		PrepareKey( m_Key, m_gameTable );
+		for ( int j = 0; j < 8; ++j )
+		{
+			const byte bEnc = pInput[i + j];
+			pOutput[i + j] = bEnc ^ m_Key.u_cKey[7 - j];
+			m_Key.u_cKey[7 - j] = bEnc;
+		}
 	}
 
+	for ( ; i < len; ++i )
+		pOutput[i] = DecryptBFByte( pInput[i] );
+
+	if ( inLen > outLen )
+		return false;
+
 	m_gameStreamPos += inLen;
     return true;
 }
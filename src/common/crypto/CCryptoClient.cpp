@@ -0,0 +1,80 @@
+#include "../../sphere/threads.h"
+#include "CCrypto.h"
+#include "CMD5.h"
+#include <cstring> // for memcpy
+
+// Client side of the encryption, used by the headless client (tools/headless).
+// The login and Twofish ciphers are keystreams that don't depend on the data, so the client encrypts
+//  exactly the way the server decrypts, and it decrypts the MD5 stream the way the server encrypts it.
+// Blowfish instead depends on the encrypted data (its client side isn't the same as the server one): clients
+//  using it (ENC_BFISH, ENC_BTFISH) aren't supported.
+
+bool CCrypto::InitClient( dword dwSeed, dword dwClientVer, CONNECT_TYPE ctInit )
+{
+	ADDTOCALLSTACK("CCrypto::InitClient");
+	m_fInit = false;
+	m_fRelayPacket = false;
+
+	// SphereCrypt.ini has no patch number for the clients using the new versioning (eg: 7.0.15.1 uses the keys of 7.0.15)
+	if ( !SetClientVerEnum( dwClientVer ) && !SetClientVerEnum( dwClientVer - (dwClientVer % 100) ) )
+		return false;
+	if ( !SetConnectType( ctInit ) )
+		return false;
+
+	m_seed = dwSeed;
+	dword dwMaskHi, dwMaskLo;
+	GetLoginCryptMask( m_seed, dwMaskHi, dwMaskLo );
+	SetCryptMask( dwMaskHi, dwMaskLo );
+
+	if ( ctInit == CONNECT_GAME )
+	{
+		const ENCRYPTION_TYPE enc = GetEncryptionType();
+		if ( (enc == ENC_BFISH) || (enc == ENC_BTFISH) )
+			return false;
+		if ( enc == ENC_TFISH )
+		{
+			m_md5_engine->reset();
+			InitTwoFish();
+		}
+	}
+	else if ( ctInit != CONNECT_LOGIN )
+	{
+		return false;
+	}
+
+	m_fInit = true;
+	return true;
+}
+
+bool CCrypto::EncryptClient( byte * pOutput, const byte * pInput, uint outLen, uint inLen )
+{
+	ADDTOCALLSTACK("CCrypto::EncryptClient");
+	if ( !m_fInit || !inLen || (inLen > outLen) )
+		return false;
+
+	const ENCRYPTION_TYPE enc = GetEncryptionType();
+	if ( GetClientVer() && ((m_ConnectType == CONNECT_LOGIN) || (enc == ENC_LOGIN)) )
+		return DecryptLogin( pOutput, pInput, outLen, inLen );
+
+	if ( (m_ConnectType == CONNECT_GAME) && (enc == ENC_TFISH) )
+		return DecryptTwoFish( pOutput, pInput, outLen, inLen );
+
+	if ( pOutput != pInput )
+		memcpy( pOutput, pInput, inLen );
+	return true;
+}
+
+bool CCrypto::DecryptClient( byte * pOutput, const byte * pInput, uint outLen, uint inLen )
+{
+	ADDTOCALLSTACK("CCrypto::DecryptClient");
+	if ( !m_fInit || !inLen || (inLen > outLen) )
+		return false;
+
+	// Only the Twofish clients get encrypted data (see CNetworkOutput::sendPacketData)
+	if ( (m_ConnectType == CONNECT_GAME) && (GetEncryptionType() == ENC_TFISH) )
+		return EncryptMD5( pOutput, pInput, outLen, inLen );
+
+	if ( pOutput != pInput )
+		memcpy( pOutput, pInput, inLen );
+	return true;
+}
@@ -0,0 +1,221 @@
+//
+// CCryptoCore.cpp
+//
+// State of the encryption engine and the client keys: nothing here depends on the rest of the server,
+//  so the headless client (tools/headless) links these files too.
+//
+
+#include "../../sphere/threads.h"
+#include "CCrypto.h"
+
+// For TwoFish and MD5 we only provide an interface, so we include the headers of the code doing all the related crypto stuff
+#include "twofish/twofish.h"
+#include "CMD5.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define CRYPT_USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+// ===============================================================================================================
+// ---------------------------------------------------------------------------------------------------------------
+// ===============================================================================================================
+
+/*		Login keys from SphereCrypt.ini		*/
+
+std::vector<CCryptoClientKey> CCrypto::client_keys;
+
+void CCrypto::SetClientVersion( dword iVer )
+{
+	m_iClientVersion = iVer;
+}
+
+void CCrypto::SetMasterKeys( dword hi, dword low )
+{
+	m_MasterHi = hi;
+	m_MasterLo = low;
+}
+
+void CCrypto::SetCryptMask( dword hi, dword low )
+{
+	m_CryptMaskHi = hi;
+	m_CryptMaskLo= low;
+}
+
+bool CCrypto::SetConnectType( CONNECT_TYPE ctWho )
+{
+	if ( ctWho > CONNECT_NONE && ctWho < CONNECT_QTY )
+	{
+		m_ConnectType = ctWho;
+		return true;
+	}
+
+	return false;
+}
+
+bool CCrypto::SetEncryptionType( ENCRYPTION_TYPE etWho )
+{
+	if ( etWho >= ENC_NONE && etWho < ENC_QTY )
+	{
+		m_GameEnc = etWho;
+		return true;
+	}
+
+	return false;
+}
+
+dword CCrypto::GetClientVer() const
+{
+	return m_iClientVersion;
+}
+
+bool CCrypto::IsValid() const
+{
+	return ( m_iClientVersion > 0 );
+	//return ( (m_iClientVersion > 0) && (m_iClientVersion < 10000000) );	// should be safer? which versions do the Enhanced clients report?
+}
+
+bool CCrypto::IsInit() const
+{
+	return m_fInit;
+}
+
+CONNECT_TYPE CCrypto::GetConnectType() const
+{
+	return m_ConnectType;
+}
+
+ENCRYPTION_TYPE CCrypto::GetEncryptionType() const
+{
+	return m_GameEnc;
+}
+
+void CCrypto::addNoCryptKey(void)
+{
+	ADDTOCALLSTACK("CCrypto::addNoCryptKey");
+	CCryptoClientKey c;
+	c.m_client = 0;
+	c.m_key_1 = 0;
+	c.m_key_2 = 0;
+	c.m_EncType = ENC_NONE;
+	client_keys.emplace_back(c);
+}
+
+bool CCrypto::SetClientVerEnum( dword iVer, bool bSetEncrypt )
+{
+	ADDTOCALLSTACK("CCrypto::SetClientVerEnum");
+	for (size_t i = 0; i < client_keys.size(); ++i )
+	{
+		CCryptoClientKey & key = client_keys[i];
+
+		if ( iVer == key.m_client )
+		{
+			if ( SetClientVerIndex( i, bSetEncrypt ))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+bool CCrypto::SetClientVerIndex( size_t iVer, bool bSetEncrypt )
+{
+	ADDTOCALLSTACK("CCrypto::SetClientVerIndex");
+	if ( iVer >= client_keys.size() )
+		return false;
+
+	CCryptoClientKey & key = client_keys[iVer];
+
+	SetClientVersion(key.m_client);
+	SetMasterKeys(key.m_key_1, key.m_key_2); // Hi - Lo
+	if ( bSetEncrypt )
+		SetEncryptionType(key.m_EncType);
+
+	return true;
+}
+
+void CCrypto::SetClientVer( const CCrypto & crypt )
+{
+	ADDTOCALLSTACK("CCrypto::SetClientVer");
+	m_fInit = false;
+	m_iClientVersion = crypt.m_iClientVersion;
+	m_MasterHi = crypt.m_MasterHi;
+	m_MasterLo = crypt.m_MasterLo;
+}
+
+int CCrypto::GetVerFromNumber( dword maj, dword min, dword rev, dword pat )
+{
+	ADDTOCALLSTACK("CCrypto::GetVerFromNumber");
+	// Get version of new clients (5.0.6.5+), which report the client version as numbers (eg: 5,0,6,5)
+
+	return (maj * 1000000) + (min * 10000) + (rev * 100) + pat;
+}
+
+// ===============================================================================================================
+// ---------------------------------------------------------------------------------------------------------------
+// ===============================================================================================================
+
+/*		Init encryption engine		*/
+
+CCrypto::CCrypto()
+{
+	// Always at least one crypt code, for non encrypted clients!
+	if ( ! client_keys.size() )
+		addNoCryptKey();
+
+	m_fInit = false;
+	m_fRelayPacket = false;
+	//SetClientVerEnum(client_keys[0][2]);
+	SetClientVerEnum(0);
+
+	tf_cipher	= new cipherInstance;
+	tf_key		= new keyInstance;
+	m_md5_engine	= new CMD5();
+
+	m_CryptMaskHi = m_CryptMaskLo = 0;
+	m_seed = 0;
+	m_ConnectType = CONNECT_NONE;
+	tf_position = 0;
+	m_gameTable = 0;
+	m_gameBlockPos = 0;
+	m_gameStreamPos = 0;
+	m_md5_position = 0;
+}
+
+CCrypto::~CCrypto()
+{
+	delete tf_cipher;
+	delete tf_key;
+	delete m_md5_engine;
+}
+
+// ===============================================================================================================
+// ---------------------------------------------------------------------------------------------------------------
+// ===============================================================================================================
+
+/*		Encryption utility methods		*/
+
+void CCrypto::XorKeystream( byte * pOutput, const byte * pInput, const byte * pKey, size_t uiLen )	// static
+{
+	// pOutput = pInput ^ pKey, a whole run of keystream at once (pOutput may be pInput)
+	size_t i = 0;
+#ifdef CRYPT_USE_SSE2
+	for ( ; (i + 16) <= uiLen; i += 16 )
+	{
+		const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pInput + i));
+		const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pKey + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(pOutput + i), _mm_xor_si128(data, key));
+	}
+#endif
+	for ( ; (i + 8) <= uiLen; i += 8 )
+	{
+		ullong data, key;
+		memcpy(&data, pInput + i, sizeof(data));
+		memcpy(&key, pKey + i, sizeof(key));
+		data ^= key;
+		memcpy(pOutput + i, &data, sizeof(data));
+	}
+	for ( ; i < uiLen; ++i )
+		pOutput[i] = pInput[i] ^ pKey[i];
+}
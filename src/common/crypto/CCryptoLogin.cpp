@@ -2,6 +2,13 @@
 #include "CCrypto.h"
 #include <cstring> // for memcpy
 
+void CCrypto::GetLoginCryptMask( dword dwSeed, dword & dwMaskHi, dword & dwMaskLo )	// static
+{
+	// Initial mask of the login encryption, it only depends on the seed
+	dwMaskLo = (((~dwSeed) ^ 0x00001357) << 16) | ((( dwSeed) ^ 0xffffaaaa) & 0x0000ffff);
+	dwMaskHi = ((( dwSeed) ^ 0x43210000) >> 16) | (((~dwSeed) ^ 0xabcdffff) & 0xffff0000);
+}
+
 // Encryption used when logging in, to access the server list
 bool CCrypto::DecryptLogin( byte * pOutput, const byte * pInput, size_t outLen, size_t inLen )
 {
@@ -11,18 +11,23 @@ void CCrypto::InitMD5(byte * ucInitialize)
 	m_md5_engine->update( ucInitialize, TFISH_RESET );
 	m_md5_engine->finalize();
 	m_md5_engine->numericDigest( &m_md5_digest[0] );
+
+	for ( size_t i = 0; i < sizeof(m_md5_keystream); i += sizeof(m_md5_digest) )
+		memcpy( &m_md5_keystream[i], m_md5_digest, minimum(sizeof(m_md5_digest), sizeof(m_md5_keystream) - i) );
 }
 
 bool CCrypto::EncryptMD5( byte * pOutput, const byte * pInput, size_t outLen, size_t inLen )
 {
 	ADDTOCALLSTACK("CCrypto::EncryptMD5");
 
-	for (size_t i = 0; i < inLen; ++i)
+	// the keystream repeats every 16 bytes, so it can be read in runs starting from the current position
+	const size_t len = minimum(inLen, outLen);
+	for (size_t i = 0; i < len; )
 	{
-        if (i >= outLen)
-            return false; // error: i'm trying to write more bytes than the output buffer length
-		pOutput[i] = pInput[i] ^ m_md5_digest[m_md5_position++];
-		m_md5_position &= MD5_RESET;
+		const size_t run = minimum(len - i, (size_t)MD5_KEYSTREAM);
+		XorKeystream( &pOutput[i], &pInput[i], &m_md5_keystream[m_md5_position], run );
+		m_md5_position = (uint)((m_md5_position + run) & MD5_RESET);
+		i += run;
 	}
-    return true;
+    return (inLen <= outLen); // error: i'm trying to write more bytes than the output buffer length
 }
@@ -47,11 +47,10 @@ bool CCrypto::DecryptTwoFish( byte * pOutput, const byte * pInput, size_t outLen
 	ADDTOCALLSTACK("CCrypto::DecryptTwoFish");
 	byte tmpBuff[TFISH_RESET];
 
-	for ( size_t i = 0; i < inLen; ++i )
+	// xor whole runs of the cipher table, up to the point it has to be regenerated
+	const size_t len = minimum(inLen, outLen);
+	for ( size_t i = 0; i < len; )
 	{
-        if (i >= outLen)
-            return false;
-
 		if ( tf_position >= TFISH_RESET )
 		{
 			blockEncrypt( tf_cipher, tf_key, &tf_cipherTable[0], 0x800, &tmpBuff[0] ); // function09
@@ -59,7 +58,10 @@ bool CCrypto::DecryptTwoFish( byte * pOutput, const byte * pInput, size_t outLen
 			tf_position = 0;
 		}
 
-		pOutput[i] = pInput[i] ^ tf_cipherTable[tf_position++];
+		const size_t run = minimum(len - i, (size_t)(TFISH_RESET - tf_position));
+		XorKeystream( &pOutput[i], &pInput[i], &tf_cipherTable[tf_position], run );
+		tf_position += (int)run;
+		i += run;
 	}
-    return true;
+    return (inLen <= outLen);
 }
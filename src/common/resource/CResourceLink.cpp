@@ -7,6 +7,7 @@
 #include "../../game/items/CItem.h"
 #include "../../game/triggers.h"
 #include "../CLog.h"
+#include "../CScriptTriggerArgs.h"
 #include "sections/CSkillDef.h"
 #include "sections/CSpellDef.h"
 #include "sections/CRegionResourceDef.h"
@@ -15,11 +16,155 @@
 #include "CResourceLink.h"
 
 
+// A line of the section, as far as skipping blocks is concerned.
+struct CScanLine
+{
+    int m_iType;                    // SCRIPTBLOCK_TYPE or SCANLINE_TRIGGER
+    CScriptLineContext m_Start;     // before reading the line
+    int m_iOffsetNext;              // after reading the line
+};
+#define SCANLINE_TRIGGER -1         // ON=@trigger, a skipped block never goes past it
+
+static int MatchBlockEnd( const std::vector<CScanLine> & vLines, size_t uiFirst, std::vector<int> & vMatches )
+{
+    // Do what OnTriggerRun does with TRIGRUN_SECTION_FALSE, starting at line uiFirst.
+    // RETURN: index of the line where it stops, -1 if it would run into the next trigger or the end of the section.
+    if ( uiFirst >= vLines.size() )
+        return -1;
+    if ( vMatches[uiFirst] != -2 )
+        return vMatches[uiFirst];
+
+    int iEnd = -1;
+    size_t i = uiFirst;
+    while ( i < vLines.size() )
+    {
+        const int iType = vLines[i].m_iType;
+        if ( iType == SCANLINE_TRIGGER )
+            break;
+        if ( (iType == SCRIPTBLOCK_ELSE) || (iType == SCRIPTBLOCK_END) )
+        {
+            iEnd = (int)i;
+            break;
+        }
+
+        if ( iType == SCRIPTBLOCK_IF )
+        {
+            // every branch, up to the ENDIF
+            int iBranchEnd = (int)i;
+            do
+            {
+                iBranchEnd = MatchBlockEnd( vLines, (size_t)iBranchEnd + 1, vMatches );
+            } while ( (iBranchEnd >= 0) && (vLines[iBranchEnd].m_iType == SCRIPTBLOCK_ELSE) );
+
+            if ( iBranchEnd < 0 )
+                break;
+            i = (size_t)iBranchEnd + 1;
+        }
+        else if ( iType == SCRIPTBLOCK_OPEN )
+        {
+            const int iBlockEnd = MatchBlockEnd( vLines, i + 1, vMatches );
+            if ( iBlockEnd < 0 )
+                break;
+            i = (size_t)iBlockEnd + 1;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    vMatches[uiFirst] = iEnd;
+    return iEnd;
+}
+
+static void ScanArgsBinds( lpctstr ptcText, std::vector<std::string> & vFrameNames, CResourceLink::LineBinds & lineBinds )
+{
+    // Find the LOCAL.name and ARGV[n] written with a literal name or index, and give each LOCAL name its slot in the frame.
+    // A name completed by a <...> is only known when running the line: it's left to the named LOCALs.
+    for ( lpctstr ptcScan = ptcText; *ptcScan != '\0'; ++ptcScan )
+    {
+        if ( (ptcScan != ptcText) && (_ISCSYM(ptcScan[-1]) || (ptcScan[-1] == '.')) )
+            continue;
+
+        if ( !strnicmp( ptcScan, "LOCAL.", 6 ) )
+        {
+            lpctstr ptcName = ptcScan + 6;
+            lpctstr ptcEnd = ptcName;
+            while ( _ISCSYM(*ptcEnd) || (*ptcEnd == '.') )
+                ++ptcEnd;
+            if ( (ptcEnd == ptcName) || (*ptcEnd == '<') )
+                continue;
+
+            std::string sName( ptcName, (size_t)(ptcEnd - ptcName) );
+            ptcScan = ptcEnd - 1;
+            if ( lineBinds.Find( sName.c_str(), false ) )
+                continue;
+
+            size_t uiSlot = 0;
+            while ( (uiSlot < vFrameNames.size()) && strcmpi( vFrameNames[uiSlot].c_str(), sName.c_str() ) )
+                ++uiSlot;
+            if ( uiSlot == vFrameNames.size() )
+            {
+                if ( uiSlot >= CScriptTriggerArgs::kuiLocalSlots )
+                    continue;   // the frame is full, this one is only found by name
+                vFrameNames.push_back( sName );
+            }
+            lineBinds.m_vBinds.push_back( { std::move(sName), (uint)uiSlot, false } );
+        }
+        else if ( !strnicmp( ptcScan, "ARGV", 4 ) )
+        {
+            // <ARGV[n]>, <ARGV.n> or <ARGVn>, n decimal (a leading 0 would make it hexadecimal)
+            lpctstr ptcIndex = ptcScan + 4;
+            SKIP_SEPARATORS( ptcIndex );
+            lpctstr ptcDigits = ptcIndex;
+            const bool fBracket = (*ptcDigits == '[');
+            if ( fBracket )
+                ++ptcDigits;
+            lpctstr ptcEnd = ptcDigits;
+            while ( IsDigit(*ptcEnd) )
+                ++ptcEnd;
+            if ( (ptcEnd == ptcDigits) || ((*ptcDigits == '0') && (ptcEnd - ptcDigits > 1)) )
+                continue;
+
+            const uint uiIndex = (uint)atoi( ptcDigits );
+            if ( fBracket )
+            {
+                if ( *ptcEnd != ']' )
+                    continue;
+                ++ptcEnd;
+            }
+            if ( *ptcEnd != '>' )
+                continue;
+
+            std::string sIndex( ptcIndex, (size_t)(ptcEnd - ptcIndex) );
+            ptcScan = ptcEnd - 1;
+            if ( !lineBinds.Find( sIndex.c_str(), true ) )
+                lineBinds.m_vBinds.push_back( { std::move(sIndex), uiIndex, true } );
+        }
+    }
+}
+
+static void ScanNatives( lpctstr ptcText, CResourceLink::LineBinds & lineBinds )
+{
+    // Find the natives called with a literal name, <NAME(...)>: running the line doesn't have to look for them.
+    for ( lpctstr ptcScan = strchr( ptcText, '<' ); ptcScan != nullptr; ptcScan = strchr( ptcScan + 1, '<' ) )
+    {
+        const CScriptNatives::Native_s * pNative = CScriptNatives::Get().Find( ptcScan + 1 );
+        if ( (pNative != nullptr) && (std::find( lineBinds.m_vNatives.begin(), lineBinds.m_vNatives.end(), pNative ) == lineBinds.m_vNatives.end()) )
+            lineBinds.m_vNatives.push_back( pNative );
+    }
+}
+
+
+uint CResourceLink::sm_uiTriggersGeneration = 1;
+uint CResourceLink::sm_uiNextFrame = 1;
+
 CResourceLink::CResourceLink(const CResourceID& rid, const CVarDefContNum * pDef) :
     CResourceDef( rid, pDef )
 {
     m_pScript = nullptr;
     _dwRefInstances = 0;
+    m_fTriggerContexts = false;
     ClearTriggers();
 }
 
@@ -27,6 +172,10 @@ void CResourceLink::ScanSection( RES_TYPE restype )
 {
     ADDTOCALLSTACK("CResourceLink::ScanSection");
     // Scan the section we are linking to for useful stuff.
+    // Also remember where each trigger starts, so that firing it doesn't have to read the whole section again,
+    // and where each block ends, so that skipping it (false IF branch...) doesn't have to read it,
+    // and give each LOCAL written with a literal name a slot in the frame of its trigger (or function),
+    // and find the natives each line calls.
     ASSERT(m_pScript);
     lpctstr const * ppTable = nullptr;
     int iQty = 0;
@@ -72,19 +221,38 @@ void CResourceLink::ScanSection( RES_TYPE restype )
     }
     ClearTriggers();
 
+    std::vector<CScanLine> vLines;
+    std::vector<std::string> vFrameNames;
+    uint uiFrame = NewFrame();
+    CScriptLineContext lineContext = m_pScript->GetContext();
     while ( m_pScript->ReadKey(false) )
     {
+        CScanLine line;
+        line.m_Start = lineContext;
+        lineContext = m_pScript->GetContext();
+        line.m_iOffsetNext = lineContext.m_iOffset;
+
         if ( m_pScript->IsKeyHead( "DEFNAME", 7 ) )
         {
             m_pScript->ParseKeyLate();
             SetResourceName( m_pScript->GetArgRaw() );
+            line.m_iType = SCRIPTBLOCK_NONE;
+            vLines.push_back( line );
         }
         else if ( m_pScript->IsKeyHead( "ON", 2 ) )
         {
+            line.m_iType = SCANLINE_TRIGGER;
+            vLines.push_back( line );
+            vFrameNames.clear();
+            uiFrame = NewFrame();
+
+            m_pScript->ParseKeyLate();
+            if ( !FindTriggerContext( m_pScript->GetArgRaw() ) )  // only the first one is ever run
+                m_vTriggerContexts.push_back( { m_pScript->GetArgRaw(), lineContext } );
+
             int iTrigger;
             if ( iQty )
             {
-                m_pScript->ParseKeyLate();
                 iTrigger = FindTableSorted( m_pScript->GetArgRaw(), ppTable, iQty );
 
                 if ( iTrigger < 0 )	// unknown triggers ?
@@ -106,9 +274,99 @@ void CResourceLink::ScanSection( RES_TYPE restype )
 
             SetTrigger(iTrigger);
         }
+        else
+        {
+            // split the line the same way ReadKeyParse does when running it
+            m_pScript->ParseKeyLate();
+            line.m_iType = m_pScript->IsKeyHead( "ON", 2 ) ? SCANLINE_TRIGGER : CScriptObj::GetScriptBlockType( m_pScript->GetKey() );
+            vLines.push_back( line );
+
+            LineBinds lineBinds;
+            lineBinds.m_iLineNum = m_pScript->m_iLineNum;
+            lineBinds.m_uiFrame = uiFrame;
+            ScanArgsBinds( m_pScript->GetKey(), vFrameNames, lineBinds );
+            ScanArgsBinds( m_pScript->GetArgRaw(), vFrameNames, lineBinds );
+            ScanNatives( m_pScript->GetKey(), lineBinds );
+            ScanNatives( m_pScript->GetArgRaw(), lineBinds );
+            if ( !lineBinds.m_vBinds.empty() || !lineBinds.m_vNatives.empty() )
+                m_vLineBinds.push_back( std::move(lineBinds) );
+        }
+    }
+    m_fTriggerContexts = true;
+
+    std::vector<int> vMatches( vLines.size(), -2 );
+    for ( size_t i = 0; i < vLines.size(); ++i )
+    {
+        const int iType = vLines[i].m_iType;
+        if ( (iType != SCRIPTBLOCK_IF) && (iType != SCRIPTBLOCK_OPEN) && (iType != SCRIPTBLOCK_ELSE) )
+            continue;
+
+        const int iEnd = MatchBlockEnd( vLines, i + 1, vMatches );
+        if ( iEnd >= 0 )
+            m_vBlockEnds.push_back( { vLines[i].m_iOffsetNext, vLines[iEnd].m_Start } );
     }
 }
 
+const CScriptLineContext * CResourceLink::FindTriggerContext( lpctstr pszTrigName ) const
+{
+    ADDTOCALLSTACK("CResourceLink::FindTriggerContext");
+    for ( const TriggerContext & trigger : m_vTriggerContexts )
+    {
+        if ( !strcmpi( trigger.m_sName.c_str(), pszTrigName ) )
+            return &trigger.m_Context;
+    }
+    return nullptr;
+}
+
+const CResourceLink::LineBinds * CResourceLink::FindLineBinds( int iLineNum ) const
+{
+    // Called for each LOCAL and ARGV read or set, keep it light.
+    const auto it = std::lower_bound( m_vLineBinds.begin(), m_vLineBinds.end(), iLineNum,
+        []( const LineBinds & lineBinds, int iValue ) { return lineBinds.m_iLineNum < iValue; } );
+    if ( (it == m_vLineBinds.end()) || (it->m_iLineNum != iLineNum) )
+        return nullptr;
+    return &(*it);
+}
+
+const CResourceLink::ArgsBind * CResourceLink::LineBinds::Find( lpctstr ptcKey, bool fArgv ) const
+{
+    for ( const ArgsBind & bind : m_vBinds )
+    {
+        if ( (bind.m_fArgv == fArgv) && !strcmpi( bind.m_sKey.c_str(), ptcKey ) )
+            return &bind;
+    }
+    return nullptr;
+}
+
+const CScriptNatives::Native_s * CResourceLink::LineBinds::FindNative( lpctstr ptcKey ) const
+{
+    for ( const CScriptNatives::Native_s * pNative : m_vNatives )
+    {
+        const size_t uiLen = pNative->m_sName.GetLength();
+        if ( !strnicmp( pNative->m_sName.GetBuffer(), ptcKey, uiLen ) && (ptcKey[uiLen] == '(') )
+            return pNative;
+    }
+    return nullptr;
+}
+
+uint CResourceLink::NewFrame() noexcept // static
+{
+    const uint uiFrame = sm_uiNextFrame++;
+    if ( sm_uiNextFrame == 0 )
+        sm_uiNextFrame = 1;     // 0 = no frame
+    return uiFrame;
+}
+
+const CScriptLineContext * CResourceLink::FindBlockEnd( int iOffset ) const
+{
+    // Called on every skipped block, keep it light.
+    const auto it = std::lower_bound( m_vBlockEnds.begin(), m_vBlockEnds.end(), iOffset,
+        []( const BlockEnd & blockEnd, int iValue ) { return blockEnd.m_iOffset < iValue; } );
+    if ( (it == m_vBlockEnds.end()) || (it->m_iOffset != iOffset) )
+        return nullptr;
+    return &it->m_Context;
+}
+
 void CResourceLink::DelRefInstance()
 {
 #ifdef _DEBUG
@@ -152,6 +410,11 @@ void CResourceLink::CopyTransfer(CResourceLink *pLink)
     m_pScript = pLink->m_pScript;
     m_Context = pLink->m_Context;
     memcpy(m_dwOnTriggers, pLink->m_dwOnTriggers, sizeof(m_dwOnTriggers));
+    OnTriggersChanged();
+    m_vTriggerContexts = pLink->m_vTriggerContexts;
+    m_fTriggerContexts = pLink->m_fTriggerContexts;
+    m_vBlockEnds = pLink->m_vBlockEnds;
+    m_vLineBinds = pLink->m_vLineBinds;
     _dwRefInstances = pLink->_dwRefInstances;
     pLink->_dwRefInstances = 0;	// instance has been transfered.
 }
@@ -159,6 +422,11 @@ void CResourceLink::CopyTransfer(CResourceLink *pLink)
 void CResourceLink::ClearTriggers()
 {
     memset(m_dwOnTriggers, 0, sizeof(m_dwOnTriggers));
+    OnTriggersChanged();
+    m_vTriggerContexts.clear();
+    m_fTriggerContexts = false;
+    m_vBlockEnds.clear();
+    m_vLineBinds.clear();
 }
 
 void CResourceLink::SetTrigger(int i)
@@ -172,6 +440,7 @@ void CResourceLink::SetTrigger(int i)
             {
                 const dword flag = 1 << i;
                 m_dwOnTriggers[j] |= flag;
+                OnTriggersChanged();
                 return;
             }
             i -= 32;
@@ -183,6 +452,11 @@ bool CResourceLink::HasTrigger(int i) const
 {
     ADDTOCALLSTACK("CResourceLink::HasTrigger");
     // Specific to the RES_TYPE; CTRIG_QTY, ITRIG_QTY or RTRIG_QTY
+    return IsTriggerSet(m_dwOnTriggers, i);
+}
+
+bool CResourceLink::IsTriggerSet(const dword (&dwTriggers)[MAX_TRIGGERS_ARRAY], int i) noexcept // static
+{
     if ( i < XTRIG_UNKNOWN )
         i = XTRIG_UNKNOWN;
 
@@ -191,13 +465,19 @@ bool CResourceLink::HasTrigger(int i) const
         if ( i < 32 )
         {
             dword flag = 1 << i;
-            return ((m_dwOnTriggers[j] & flag) != 0);
+            return ((dwTriggers[j] & flag) != 0);
         }
         i -= 32;
     }
     return false;
 }
 
+void CResourceLink::MergeTriggers(dword (&dwTriggers)[MAX_TRIGGERS_ARRAY]) const noexcept
+{
+    for ( int j = 0; j < MAX_TRIGGERS_ARRAY; ++j )
+        dwTriggers[j] |= m_dwOnTriggers[j];
+}
+
 bool CResourceLink::ResourceLock( CResourceLock &s )
 {
     ADDTOCALLSTACK("CResourceLink::ResourceLock");
@@ -211,7 +491,7 @@ bool CResourceLink::ResourceLock( CResourceLock &s )
     ASSERT(m_pScript);
 
     //	Give several tryes to lock the script while multithreading
-    int iRet = s.OpenLock( m_pScript, m_Context );
+    int iRet = s.OpenLock( m_pScript, m_Context, this );
     if ( ! iRet )
         return true;
 
@@ -7,7 +7,10 @@
 #define _INC_CRESOURCELINK_H
 
 #include "../CScriptContexts.h"
+#include "../CScriptNatives.h"
 #include "CResourceDef.h"
+#include <string>
+#include <vector>
 
 class CResourceScript;
 
@@ -24,8 +27,47 @@ private:
     CResourceScript * m_pScript;	// we already found the script.
     CScriptLineContext m_Context;
 
+    struct TriggerContext
+    {
+        std::string m_sName;            // as written after ON=
+        CScriptLineContext m_Context;   // first line of the trigger body
+    };
+    std::vector<TriggerContext> m_vTriggerContexts;    // filled by ScanSection, in script order
+    bool m_fTriggerContexts;            // the section has been scanned, m_vTriggerContexts is complete
+
+    struct BlockEnd
+    {
+        int m_iOffset;                  // where the block body starts (just after IF, ELSE, WHILE, BEGIN...)
+        CScriptLineContext m_Context;   // the line ending it (ELSE, ELIF, END...)
+    };
+    std::vector<BlockEnd> m_vBlockEnds;    // sorted by m_iOffset
+
+public:
+    struct ArgsBind
+    {
+        std::string m_sKey;             // the name after LOCAL., or the index after ARGV, as written
+        uint m_uiSlot;                  // slot of the LOCAL in the frame of its trigger or function, or the ARGV index
+        bool m_fArgv;
+    };
+    struct LineBinds
+    {
+        int m_iLineNum;                 // the line number of the script after reading the line
+        uint m_uiFrame;                 // the trigger or function the line belongs to: its LOCALs share the same slots
+        std::vector<ArgsBind> m_vBinds;
+        std::vector<const CScriptNatives::Native_s *> m_vNatives;  // the natives called in the line with a literal name, <NAME(...)>
+
+        const ArgsBind * Find( lpctstr ptcKey, bool fArgv ) const;
+        const CScriptNatives::Native_s * FindNative( lpctstr ptcKey ) const;
+    };
+private:
+    std::vector<LineBinds> m_vLineBinds;   // the lines with a LOCAL.name or ARGV[n] written with a literal name or index, or calling a native, sorted by m_iLineNum
+    static uint sm_uiNextFrame;
+    static uint NewFrame() noexcept;
+
     dword _dwRefInstances;	// How many CResourceRef objects refer to this ?
 
+    static uint sm_uiTriggersGeneration;
+
 public:
     static const char *m_sClassName;
     dword m_dwOnTriggers[MAX_TRIGGERS_ARRAY];
@@ -54,6 +96,29 @@ public:
     void ClearTriggers();
     void SetTrigger( int i );
     bool HasTrigger( int i ) const;
+    static bool IsTriggerSet( const dword (&dwTriggers)[MAX_TRIGGERS_ARRAY], int i ) noexcept;
+    void MergeTriggers( dword (&dwTriggers)[MAX_TRIGGERS_ARRAY] ) const noexcept;
+
+    // Changes every time the triggers of a link, or the global lists of events set in the .ini, are modified (load, resync):
+    //  objects keeping the merged triggers of their events (CChar, CItemBase) compare it to know when to merge them again.
+    //  The lists of events of the objects have their own generation (CResourceRefArray::GetGeneration).
+    static uint GetTriggersGeneration() noexcept
+    {
+        return sm_uiTriggersGeneration;
+    }
+    static void OnTriggersChanged() noexcept
+    {
+        ++sm_uiTriggersGeneration;
+        if (sm_uiTriggersGeneration == 0)
+            sm_uiTriggersGeneration = 1;    // 0 = never merged
+    }
+    bool HasTriggerContexts() const noexcept
+    {
+        return m_fTriggerContexts;
+    }
+    const CScriptLineContext * FindTriggerContext( lpctstr pszTrigName ) const;
+    const CScriptLineContext * FindBlockEnd( int iOffset ) const;
+    const LineBinds * FindLineBinds( int iLineNum ) const;
     bool ResourceLock( CResourceLock & s );
 
 public:
@@ -94,7 +94,7 @@ bool CResourceLock::ReadTextLine( bool fRemoveBlanks ) // Read a line from the o
     THREAD_UNIQUE_LOCK_RETURN(CResourceLock::_ReadTextLine(fRemoveBlanks));
 }
 
-int CResourceLock::OpenLock( CResourceScript * pLock, CScriptLineContext context )
+int CResourceLock::OpenLock( CResourceScript * pLock, CScriptLineContext context, const CResourceLink * pLink )
 {
     ADDTOCALLSTACK("CResourceLock::OpenLock");
     // ONLY called from CResourceLink
@@ -109,6 +109,8 @@ int CResourceLock::OpenLock( CResourceScript * pLock, CScriptLineContext context
     if (!SeekContext(context))
         return -3;
 
+    m_pLink = pLink;
+
     // Propagate m_iResourceFileIndex from the CResourceScript to this CResourceLock
     m_iResourceFileIndex = m_pLock->m_iResourceFileIndex;
 
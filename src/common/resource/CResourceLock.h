@@ -9,6 +9,7 @@
 #include "../CScript.h"
 #include "../CScriptContexts.h"
 
+class CResourceLink;
 class CResourceScript;
 
 
@@ -19,6 +20,7 @@ class CResourceLock : public CScript
     // preserve the previous openers offset in the script.
 private:
     CResourceScript * m_pLock;
+    const CResourceLink * m_pLink;				// the section we were opened for, if any.
     CScriptLineContext m_PrvLockContext;		// i must return the locked file back here.
 
     CScriptFileContext m_PrvScriptContext;		// where was i before (context wise) opening this. (for error tracking)
@@ -27,6 +29,7 @@ private:
     void _Init()
     {
         m_pLock = nullptr;
+        m_pLink = nullptr;
         m_PrvLockContext.Init();	// means the script was NOT open when we started.
     }
 
@@ -54,7 +57,11 @@ private:
     CResourceLock& operator=(const CResourceLock& other);
 
 public:
-    int OpenLock( CResourceScript * pLock, CScriptLineContext context );
+    int OpenLock( CResourceScript * pLock, CScriptLineContext context, const CResourceLink * pLink = nullptr );
+    const CResourceLink * GetLink() const noexcept
+    {
+        return m_pLink;
+    }
     void AttachObj( const CScriptObj * pObj );
 };
 
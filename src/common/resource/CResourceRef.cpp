@@ -9,6 +9,9 @@
 #include "../CScript.h"
 #include "CResourceRef.h"
 
+
+uint CResourceRefArray::sm_uiNextGeneration = 1;
+
 CResourceRef::CResourceRef()
 {
     m_pLink = nullptr;
@@ -58,6 +61,14 @@ void CResourceRef::SetRef(CResourceLink* pLink)
 //--
 
 
+uint CResourceRefArray::NewGeneration() noexcept // static
+{
+    const uint uiGeneration = sm_uiNextGeneration++;
+    if (sm_uiNextGeneration == 0)
+        sm_uiNextGeneration = 1;    // 0 = never merged
+    return uiGeneration;
+}
+
 lpctstr CResourceRefArray::GetResourceName( size_t iIndex ) const
 {
     // look up the name of the fragment given it's index.
@@ -81,6 +92,7 @@ bool CResourceRefArray::r_LoadVal( CScript & s, RES_TYPE restype )
     tchar * pszCmd = s.GetArgStr();
     tchar * ppBlocks[128];	// max is arbitrary
     int iArgCount = Str_ParseCmds( pszCmd, ppBlocks, CountOf(ppBlocks));
+    OnChanged();   // the triggers merged from this list are not valid anymore
     for ( int i = 0; i < iArgCount; ++i )
     {
         CResourceLink* pResourceLink = nullptr;
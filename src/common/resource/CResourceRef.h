@@ -49,11 +49,34 @@ class CResourceRefArray : public std::vector<CResourceRef>
     // An indexed list of CResourceLink s.
 
 private:
+    uint m_uiGeneration;    // see GetGeneration
+    static uint sm_uiNextGeneration;
+
     lpctstr GetResourceName( size_t iIndex ) const;
+    static uint NewGeneration() noexcept;
 
 public:
     static const char *m_sClassName;
-    CResourceRefArray() = default;
+    CResourceRefArray() : m_uiGeneration(NewGeneration()) {}
+    CResourceRefArray(const CResourceRefArray& copy) : std::vector<CResourceRef>(copy), m_uiGeneration(NewGeneration()) {}
+    CResourceRefArray& operator=(const CResourceRefArray& other)
+    {
+        std::vector<CResourceRef>::operator=(other);
+        OnChanged();
+        return *this;
+    }
+
+    // Unique to this list and its content: it changes with r_LoadVal and assignments, call OnChanged after modifying
+    //  the list directly. Objects keeping the merged triggers of their events (CChar) compare it to know when to merge them again.
+    inline uint GetGeneration() const noexcept
+    {
+        return m_uiGeneration;
+    }
+    inline void OnChanged() noexcept
+    {
+        m_uiGeneration = NewGeneration();
+    }
+
     size_t FindResourceType( RES_TYPE type ) const;
     size_t FindResourceID( const CResourceID & rid ) const;
     size_t FindResourceName( RES_TYPE restype, lpctstr ptcKey ) const;
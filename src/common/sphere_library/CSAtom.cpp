@@ -0,0 +1,153 @@
+/**
+* @file CSAtom.cpp
+*/
+
+#include "CSAtom.h"
+#include "../parallel_hashmap/phmap.h"
+#include <functional>
+#include <mutex>
+
+
+struct CSAtomRef::AtomTable
+{
+	// The texts are spread over independent shards, each with its own lock: threads adding or removing different
+	//  names (TAGs set by different sectors...) rarely wait for each other.
+	static constexpr uint kuiShards = 16;
+
+	struct Shard
+	{
+		std::mutex m_Mutex;
+		phmap::flat_hash_map<std::string_view, Atom *> m_Atoms;	// the keys are the m_sText of the atoms
+	};
+	Shard m_Shards[kuiShards];
+
+	static inline uint GetShardIndex(const std::string_view& svText) noexcept {
+		return uint(std::hash<std::string_view>{}(svText) % kuiShards);
+	}
+};
+
+CSAtomRef::AtomTable & CSAtomRef::GetTable() // static
+{
+	// Never destroyed: global objects holding atoms (g_Exp and its maps...) can be destroyed after it would be.
+	static AtomTable * s_pTable = new AtomTable;
+	return *s_pTable;
+}
+
+CSAtomRef::Atom * CSAtomRef::Acquire(lpctstr ptcText, bool fShared) // static
+{
+	if ((ptcText == nullptr) || (ptcText[0] == '\0'))
+		return nullptr;
+
+	if (!fShared)
+	{
+		Atom * pAtom = new Atom;
+		pAtom->m_uiRefs.store(1, std::memory_order_relaxed);
+		pAtom->m_fShared = false;
+		pAtom->m_uiShard = 0;
+		pAtom->m_sText.assign(ptcText);
+		return pAtom;
+	}
+
+	const std::string_view svText(ptcText);
+	const uint uiShard = AtomTable::GetShardIndex(svText);
+	AtomTable::Shard & shard = GetTable().m_Shards[uiShard];
+	std::unique_lock<std::mutex> lock(shard.m_Mutex);
+
+	const auto it = shard.m_Atoms.find(svText);
+	if (it != shard.m_Atoms.end())
+	{
+		it->second->m_uiRefs.fetch_add(1, std::memory_order_relaxed);
+		return it->second;
+	}
+
+	Atom * pAtom = new Atom;
+	pAtom->m_uiRefs.store(1, std::memory_order_relaxed);
+	pAtom->m_fShared = true;
+	pAtom->m_uiShard = uiShard;
+	pAtom->m_sText.assign(svText.data(), svText.size());
+	shard.m_Atoms.emplace(std::string_view(pAtom->m_sText), pAtom);
+	return pAtom;
+}
+
+void CSAtomRef::Release(Atom * pAtom) noexcept // static
+{
+	if (!pAtom->m_fShared)
+	{
+		if (pAtom->m_uiRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete pAtom;
+		return;
+	}
+
+	// Only the last reference needs the lock: then nobody else can get the atom, if not from its shard (with the lock held).
+	uint uiRefs = pAtom->m_uiRefs.load(std::memory_order_relaxed);
+	while (uiRefs > 1)
+	{
+		if (pAtom->m_uiRefs.compare_exchange_weak(uiRefs, uiRefs - 1, std::memory_order_acq_rel))
+			return;
+	}
+
+	{
+		AtomTable::Shard & shard = GetTable().m_Shards[pAtom->m_uiShard];
+		std::unique_lock<std::mutex> lock(shard.m_Mutex);
+		if (pAtom->m_uiRefs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;	// someone took it from the table in the meanwhile
+
+		shard.m_Atoms.erase(std::string_view(pAtom->m_sText));
+	}
+	delete pAtom;
+}
+
+CSAtomRef::CSAtomRef(lpctstr ptcText, bool fShared) :
+	m_pAtom(Acquire(ptcText, fShared))
+{
+}
+
+CSAtomRef::CSAtomRef(const CSAtomRef& other) noexcept :
+	m_pAtom(other.m_pAtom)
+{
+	if (m_pAtom)
+		m_pAtom->m_uiRefs.fetch_add(1, std::memory_order_relaxed);
+}
+
+CSAtomRef::CSAtomRef(CSAtomRef&& other) noexcept :
+	m_pAtom(other.m_pAtom)
+{
+	other.m_pAtom = nullptr;
+}
+
+CSAtomRef::~CSAtomRef() noexcept
+{
+	if (m_pAtom)
+		Release(m_pAtom);
+}
+
+CSAtomRef& CSAtomRef::operator=(lpctstr ptcText)
+{
+	Atom * pAtom = Acquire(ptcText, IsShared());	// before releasing ours: ptcText can be our own text
+	if (m_pAtom)
+		Release(m_pAtom);
+	m_pAtom = pAtom;
+	return *this;
+}
+
+CSAtomRef& CSAtomRef::operator=(const CSAtomRef& other) noexcept
+{
+	if (other.m_pAtom)
+		other.m_pAtom->m_uiRefs.fetch_add(1, std::memory_order_relaxed);
+	if (m_pAtom)
+		Release(m_pAtom);
+	m_pAtom = other.m_pAtom;
+	return *this;
+}
+
+CSAtomRef& CSAtomRef::operator=(CSAtomRef&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (m_pAtom)
+			Release(m_pAtom);
+		m_pAtom = other.m_pAtom;
+		other.m_pAtom = nullptr;
+	}
+	return *this;
+}
@@ -0,0 +1,72 @@
+/**
+* @file CSAtom.h
+* @brief Interned strings, stored once and shared by every object using them.
+*/
+
+#ifndef _INC_CSATOM_H
+#define _INC_CSATOM_H
+
+#include "sstring.h"
+#include <atomic>
+#include <string>
+
+
+/**
+* @brief Reference to a string stored in the global atom table.
+*
+* The same names (TAG, VAR, DEF, LIST names...) are found on a lot of objects: each different text is stored
+*  only once, and freed when its last reference goes away. An atom is never modified, assigning another text
+*  to a CSAtomRef makes it reference another atom.
+* Getting the atom of a text locks one of the shards of the table (chosen by the hash of the text), copying a
+*  CSAtomRef doesn't. Short-lived names (LOCALs, created and destroyed at each trigger call) can use a private atom
+*  instead, allocated without going through the table.
+* This only saves memory: the maps holding the names (CVarDefMap, CListDefMap) still find them by text, ignoring case,
+*  and an atom keeps the case the name was written with, so two atoms can't be compared by address.
+*/
+class CSAtomRef
+{
+private:
+	struct Atom
+	{
+		std::atomic<uint> m_uiRefs;
+		bool m_fShared;			// false: private atom, not in the table
+		uint m_uiShard;			// shard of the table holding a shared atom
+		std::string m_sText;
+	};
+	struct AtomTable;
+
+	Atom * m_pAtom;				// nullptr = empty string
+
+public:
+	CSAtomRef() noexcept : m_pAtom(nullptr) {}
+	CSAtomRef(lpctstr ptcText, bool fShared = true);
+	CSAtomRef(const CSAtomRef& other) noexcept;
+	CSAtomRef(CSAtomRef&& other) noexcept;
+	~CSAtomRef() noexcept;
+
+	CSAtomRef& operator=(lpctstr ptcText);	// keeps the shared/private kind of the current atom
+	CSAtomRef& operator=(const CSAtomRef& other) noexcept;
+	CSAtomRef& operator=(CSAtomRef&& other) noexcept;
+
+public:
+	inline lpctstr GetBuffer() const noexcept {
+		return (m_pAtom ? m_pAtom->m_sText.c_str() : "");
+	}
+	inline size_t GetLength() const noexcept {
+		return (m_pAtom ? m_pAtom->m_sText.size() : 0);
+	}
+	inline bool IsEmpty() const noexcept {
+		return (m_pAtom == nullptr);
+	}
+	inline bool IsShared() const noexcept {
+		return (m_pAtom ? m_pAtom->m_fShared : true);
+	}
+
+private:
+	static AtomTable & GetTable();
+	static Atom * Acquire(lpctstr ptcText, bool fShared);
+	static void Release(Atom * pAtom) noexcept;
+};
+
+
+#endif // _INC_CSATOM_H
@@ -4,6 +4,8 @@
 #include "../../sphere/ProfileTask.h"
 #include "../CExpression.h"
 #include "../CScript.h"
+#include "../parallel_hashmap/phmap.h"
+#include <algorithm>
 
 
 #if defined(_MSC_VER)
@@ -682,6 +684,65 @@ void Str_SkipEnclosedAngularBrackets(tchar*& ptcLine) noexcept
 
 // String utilities: String operations
 
+namespace
+{
+    // The keyword tables (property, verb and trigger names) are searched for every script line, the bigger ones get
+    //  a case-insensitive hash index built at their first lookup instead of being binary searched with strcmpi.
+    // The index refers to the table strings, so it's only valid for tables which never change (fConstTable).
+    // Not shared between threads: each thread has its own indexes.
+
+    constexpr int kiTableIndexMinCount = 16;   // smaller tables are fast enough with the binary search
+
+    inline bool IsTableKeyChar(tchar ch) noexcept
+    {
+        // Same chars ending a match in Str_CmpHeadI_Table.
+        return (isalnum(static_cast<uchar>(ch)) || (ch == '_'));
+    }
+
+    struct TableIndex
+    {
+        int iCount;
+        bool fUsable;   // false: the table can't be indexed, use the binary search
+        phmap::flat_hash_map<std::string_view, int, StrViewHashI_s, StrViewEqualI_s> mKeys;
+    };
+
+    using TableIndexMap = phmap::flat_hash_map<lpctstr const *, TableIndex>;
+
+    // RETURN: nullptr = use the binary search
+    const TableIndex* GetTableIndex(TableIndexMap& mIndexes, lpctstr const * pptcTable, int iCount, bool fHead) noexcept
+    {
+        try
+        {
+            const auto itInsert = mIndexes.try_emplace(pptcTable);
+            TableIndex& index = itInsert.first->second;
+            if (!itInsert.second)
+                return ((index.fUsable && (index.iCount == iCount)) ? &index : nullptr);
+
+            index.iCount = iCount;
+            index.fUsable = false;
+            index.mKeys.reserve(size_t(iCount));
+            for (int i = 0; i < iCount; ++i)
+            {
+                const std::string_view svKey(pptcTable[i]);
+                if (fHead)
+                {
+                    // The match ends on the first char which can't be part of a name, so with names made only of
+                    //  these chars the key to look for is just the name at the start of the searched string.
+                    if (svKey.empty() || !std::all_of(svKey.begin(), svKey.end(), IsTableKeyChar))
+                        return nullptr;
+                }
+                index.mKeys.try_emplace(svKey, i);
+            }
+            index.fUsable = true;
+            return &index;
+        }
+        catch (const std::exception&)
+        {
+            return nullptr;
+        }
+    }
+}
+
 int FindTable(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount) noexcept
 {
     // A non-sorted table.
@@ -693,13 +754,25 @@ int FindTable(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount) noex
     return -1;
 }
 
-int FindTableSorted(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount) noexcept
+int FindTableSorted(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount, bool fConstTable) noexcept
 {
     // Do a binary search (un-cased) on a sorted table.
     // RETURN: -1 = not found
 
     if (iCount < 1)
         return -1;
+
+    if (fConstTable && (iCount >= kiTableIndexMinCount))
+    {
+        static thread_local TableIndexMap s_mIndexes;
+        const TableIndex* pIndex = GetTableIndex(s_mIndexes, pptcTable, iCount, false);
+        if (pIndex)
+        {
+            const auto it = pIndex->mKeys.find(std::string_view(ptcFind));
+            return ((it == pIndex->mKeys.end()) ? -1 : it->second);
+        }
+    }
+
     int iHigh = iCount - 1;
     int iLow = 0;
 
@@ -744,7 +817,7 @@ int FindTableHead(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount)
     return -1;
 }
 
-int FindTableHeadSorted(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount) noexcept // REQUIRES the table to be UPPERCASE, and sorted
+int FindTableHeadSorted(const lpctstr ptcFind, lpctstr const * pptcTable, int iCount, bool fConstTable) noexcept // REQUIRES the table to be UPPERCASE, and sorted
 {
     // Do a binary search (un-cased) on a sorted table.
     // Uses Str_CmpHeadI, which checks if we have reached, during comparison, ppszTable end ('\0'), ignoring if pszFind is longer (maybe has arguments?)
@@ -752,6 +825,23 @@ int FindTableHeadSorted(const lpctstr ptcFind, lpctstr const * pptcTable, int iC
 
     if (iCount < 1)
         return -1;
+
+    if (fConstTable && (iCount >= kiTableIndexMinCount))
+    {
+        static thread_local TableIndexMap s_mIndexes;
+        const TableIndex* pIndex = GetTableIndex(s_mIndexes, pptcTable, iCount, true);
+        if (pIndex)
+        {
+            size_t uiLen = 0;
+            while (IsTableKeyChar(ptcFind[uiLen]))
+                ++uiLen;
+            if (uiLen == 0)
+                return -1;
+            const auto it = pIndex->mKeys.find(std::string_view(ptcFind, uiLen));
+            return ((it == pIndex->mKeys.end()) ? -1 : it->second);
+        }
+    }
+
     int iHigh = iCount - 1;
     int iLow = 0;
 
@@ -2,6 +2,7 @@
 #define _INC_SSTRING_H
 
 #include <cstring>
+#include <string_view>
 #include "../common.h"
 
 #define STRING_NULL     "\0"
@@ -56,6 +57,37 @@ struct KeyTableDesc_s
     int iTableSize;
 };
 
+// Case-insensitive (as strcmpi) hash and comparison of string views, for hash maps with string keys.
+struct StrViewHashI_s
+{
+    size_t operator()(std::string_view svKey) const noexcept
+    {
+        // FNV-1a, folding the case with a bit: it only has to give the same hash to the keys StrViewEqualI_s finds equal.
+        size_t uiHash = 2166136261u;
+        for (const char ch : svKey)
+        {
+            uiHash ^= static_cast<size_t>(static_cast<uchar>(ch) | 0x20);
+            uiHash *= 16777619u;
+        }
+        return uiHash;
+    }
+};
+
+struct StrViewEqualI_s
+{
+    bool operator()(std::string_view svKey1, std::string_view svKey2) const noexcept
+    {
+        if (svKey1.size() != svKey2.size())
+            return false;
+        for (size_t i = 0; i < svKey1.size(); ++i)
+        {
+            if (tolower(static_cast<uchar>(svKey1[i])) != tolower(static_cast<uchar>(svKey2[i])))
+                return false;
+        }
+        return true;
+    }
+};
+
 /** @name String utilities: Modifiers
 */
 
@@ -230,10 +262,11 @@ int FindTable(const lpctstr pFind, lpctstr const * ppTable, int iCount) noexcept
 * @param pFind string we are looking for.
 * @param ppTable table where we are looking for the string.
 * @param iCount max iterations.
-* @param uiElemSize size of elements of the table.
+* @param fConstTable the table never changes (static keyword tables): the bigger ones are hash indexed at the first lookup.
+*   Pass false for tables built at runtime.
 * @return the index of string if success, -1 otherwise.
 */
-int FindTableSorted(const lpctstr pFind, lpctstr const * ppTable, int iCount) noexcept;
+int FindTableSorted(const lpctstr pFind, lpctstr const * ppTable, int iCount, bool fConstTable = true) noexcept;
 
 /**
 * @brief Look for a string header in a CAssocReg table (uses Str_CmpHeadI to compare instead of strcmpi).
@@ -260,10 +293,11 @@ int FindTableHead(const lpctstr pFind, lpctstr const * ppTable, int iCount) noex
 * @param pFind string we are looking for.
 * @param ppTable table where we are looking for the string.
 * @param iCount max iterations.
-* @param uiElemSize size of elements of the table.
+* @param fConstTable the table never changes (static keyword tables): the bigger ones are hash indexed at the first lookup.
+*   Pass false for tables built at runtime.
 * @return the index of string if success, -1 otherwise.
 */
-int FindTableHeadSorted(const lpctstr pFind, lpctstr const * ppTable, int iCount) noexcept;
+int FindTableHeadSorted(const lpctstr pFind, lpctstr const * ppTable, int iCount, bool fConstTable = true) noexcept;
 
 /**
 * @param pszIn string to check.
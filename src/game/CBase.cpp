@@ -91,6 +91,7 @@ void CBaseBaseDef::UnLink()
 {
     m_BaseResources.clear();
     m_TEvents.clear();
+    m_TEvents.OnChanged();
 	CResourceLink::UnLink();
 }
 
@@ -79,8 +79,12 @@ CObjBase::CObjBase( bool fItem )  // PROFILE_TIME_QTY is unused, CObjBase is not
 	m_ModMaxWeight = 0;
 
 	m_fStatusUpdate = 0;
-	m_PropertyList = nullptr;
-	m_PropertyHash = 0;
+	for (int i = 0; i < TOOLTIPVIEW_QTY; ++i)
+	{
+		m_PropertyList[i] = nullptr;
+		m_PropertyHash[i] = 0;
+		m_PropertyViewRevision[i] = 0;
+	}
 	m_PropertyRevision = 0;
 
 	if ( g_Serv.IsLoading())
@@ -3039,16 +3043,16 @@ void CObjBase::ResendOnEquip( bool fAllClients )
 	}
 }
 
-void CObjBase::SetPropertyList(PacketPropertyList* propertyList)
+void CObjBase::SetPropertyList(PacketPropertyList* propertyList, TOOLTIP_VIEW view)
 {
 	ADDTOCALLSTACK("CObjBase::SetPropertyList");
 	// set the property list for this object
 
-	if (propertyList == GetPropertyList())
+	if (propertyList == GetPropertyList(view))
 		return;
 
-	FreePropertyList();
-	m_PropertyList = propertyList;
+	delete m_PropertyList[view];
+	m_PropertyList[view] = propertyList;
 }
 
 void CObjBase::FreePropertyList()
@@ -3056,25 +3060,30 @@ void CObjBase::FreePropertyList()
 	ADDTOCALLSTACK("CObjBase::FreePropertyList");
 	// free m_PropertyList
 
-	if (m_PropertyList == nullptr)
-		return;
+	for (int i = 0; i < TOOLTIPVIEW_QTY; ++i)
+	{
+		if (m_PropertyList[i] == nullptr)
+			continue;
 
-	delete m_PropertyList;
-	m_PropertyList = nullptr;
+		delete m_PropertyList[i];
+		m_PropertyList[i] = nullptr;
+	}
 }
 
-dword CObjBase::UpdatePropertyRevision(dword hash)
+dword CObjBase::UpdatePropertyRevision(dword hash, TOOLTIP_VIEW view)
 {
 	ADDTOCALLSTACK("CObjBase::UpdatePropertyRevision");
 
-	if (hash != m_PropertyHash)
+	// each view keeps its revision until its own contents change, so clients of different
+	// kinds looking at the same object don't keep making each other's tooltip outdated
+	if ((hash != m_PropertyHash[view]) || (m_PropertyViewRevision[view] == 0))
 	{
 		// the property list has changed, increment the revision number
-		m_PropertyHash = hash;
-		++m_PropertyRevision;
+		m_PropertyHash[view] = hash;
+		m_PropertyViewRevision[view] = ++m_PropertyRevision;
 	}
 
-	return m_PropertyRevision;
+	return m_PropertyViewRevision[view];
 }
 
 void CObjBase::UpdatePropertyFlag()
@@ -3092,9 +3101,9 @@ void CObjBase::UpdatePropertyFlag()
     }
 }
 
-dword CObjBase::GetPropertyHash() const
+dword CObjBase::GetPropertyHash(TOOLTIP_VIEW view) const
 {
-    return m_PropertyHash;
+    return m_PropertyHash[view];
 }
 
 void CObjBase::OnTickStatusUpdate()
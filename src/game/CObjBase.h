@@ -903,57 +903,74 @@ public:
 
 public:
     std::vector<std::unique_ptr<CClientTooltip>> m_TooltipData; // Storage for tooltip data while in trigger
+
+    // Tooltip contents depending on who is looking at the object, each one has its own revision and, except the staff one, its own cached list shared by all the clients of that kind
+    enum TOOLTIP_VIEW
+    {
+        TOOLTIPVIEW_PLAYER,     // full tooltip
+        TOOLTIPVIEW_STAFF,      // full tooltip, including the GM only entries (depends on the viewer, never cached)
+        TOOLTIPVIEW_NAMEONLY,   // name only (shop items for clients without tooltips)
+        TOOLTIPVIEW_QTY
+    };
+
 protected:
-	PacketPropertyList* m_PropertyList;	// currently cached property list packet
-	dword m_PropertyHash;				// latest property list hash
-	dword m_PropertyRevision;			// current property list revision
+	PacketPropertyList* m_PropertyList[TOOLTIPVIEW_QTY];	// currently cached property list packets
+	dword m_PropertyHash[TOOLTIPVIEW_QTY];				// latest property list hashes
+	dword m_PropertyViewRevision[TOOLTIPVIEW_QTY];		// revision assigned to the latest property list hashes
+	dword m_PropertyRevision;							// current property list revision
 
 public:
 
     /**
-     * @fn  PacketPropertyList* CObjBase::GetPropertyList(void) const
+     * @fn  PacketPropertyList* CObjBase::GetPropertyList(TOOLTIP_VIEW view) const
      *
      * @brief   Gets property list.
      *
+     * @param   view    The kind of client the list is built for.
+     *
      * @return  null if it fails, else the property list.
      */
-	PacketPropertyList* GetPropertyList(void) const { return m_PropertyList; }
+	PacketPropertyList* GetPropertyList(TOOLTIP_VIEW view = TOOLTIPVIEW_PLAYER) const { return m_PropertyList[view]; }
 
     /**
-     * @fn  void CObjBase::SetPropertyList(PacketPropertyList* propertyList);
+     * @fn  void CObjBase::SetPropertyList(PacketPropertyList* propertyList, TOOLTIP_VIEW view);
      *
      * @brief   Sets property list.
      *
      * @param [in,out]  propertyList    If non-null, list of properties.
+     * @param   view                    The kind of client the list is built for.
      */
-	void SetPropertyList(PacketPropertyList* propertyList);
+	void SetPropertyList(PacketPropertyList* propertyList, TOOLTIP_VIEW view = TOOLTIPVIEW_PLAYER);
 
     /**
      * @fn  void CObjBase::FreePropertyList(void);
      *
-     * @brief   Free property list.
+     * @brief   Free the property lists of every view.
      */
 	void FreePropertyList(void);
 
     /**
-     * @fn  dword CObjBase::UpdatePropertyRevision(dword hash);
+     * @fn  dword CObjBase::UpdatePropertyRevision(dword hash, TOOLTIP_VIEW view);
      *
      * @brief   Updates the property revision described by hash.
      *
      * @param   hash    The hash.
+     * @param   view    The kind of client the list is built for.
      *
      * @return  The property revision number.
      */
-	dword UpdatePropertyRevision(dword hash);
+	dword UpdatePropertyRevision(dword hash, TOOLTIP_VIEW view = TOOLTIPVIEW_PLAYER);
 
     /**
-    * @fn  dword CObjBase::GetPropertyHash() const;
+    * @fn  dword CObjBase::GetPropertyHash(TOOLTIP_VIEW view) const;
     *
     * @brief   Gets the property revision's hash.
     *
+    * @param   view    The kind of client the list is built for.
+    *
     * @return  The property hash.
     */
-    dword GetPropertyHash() const;
+    dword GetPropertyHash(TOOLTIP_VIEW view = TOOLTIPVIEW_PLAYER) const;
 
     /**
      * @fn  void CObjBase::UpdatePropertyFlag();
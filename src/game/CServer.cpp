@@ -19,6 +19,10 @@
 #include "../network/CClientIterator.h"
 #include "../network/CIPHistoryManager.h"
 #include "../network/CNetworkManager.h"
+#include "../network/CNetworkOutput.h"
+#include "../network/CNetworkThread.h"
+#include "../network/CPacketPool.h"
+#include "../network/CPacketStats.h"
 #include "../sphere/ProfileTask.h"
 #include "../sphere/ntwindow.h"
 #include "chars/CChar.h"
@@ -1106,6 +1110,73 @@ void CServer::ProfileDump( CTextConsole * pSrc, bool bDump )
 		}
 	}
 
+	for (uint i = 0; i < PACKETPOOL_CLASSES; ++i)
+	{
+		ullong uiHits, uiMisses;
+		PacketPool::getClassStats(i, uiHits, uiMisses);
+		if ((uiHits + uiMisses) == 0)
+			continue;
+
+		char tmpstring[128];
+		snprintf(tmpstring, sizeof(tmpstring), "PacketPool %-6" PRIuSIZE_T " = %llu hits, %llu misses (%.2f%% hit rate)\n",
+			PacketPool::getClassSize(i), uiHits, uiMisses, (uiHits * 100.0) / (uiHits + uiMisses));
+		if (pSrc != this)
+		{
+			pSrc->SysMessage(tmpstring);
+		}
+		else
+		{
+			g_Log.Event(LOGL_EVENT, tmpstring);
+		}
+		if (ftDump != nullptr)
+		{
+			ftDump->Printf(tmpstring);
+		}
+	}
+
+	for (uint i = 0; i <= UCHAR_MAX; ++i)
+	{
+		const ullong uiCoalesced = CNetworkOutput::getCoalescedCount((byte)i);
+		if (uiCoalesced == 0)
+			continue;
+
+		char tmpstring[128];
+		snprintf(tmpstring, sizeof(tmpstring), "Coalesced packet 0x%02x = %llu superseded packets dropped\n", i, uiCoalesced);
+		if (pSrc != this)
+		{
+			pSrc->SysMessage(tmpstring);
+		}
+		else
+		{
+			g_Log.Event(LOGL_EVENT, tmpstring);
+		}
+		if (ftDump != nullptr)
+		{
+			ftDump->Printf(tmpstring);
+		}
+	}
+
+	for (size_t i = 0; i < g_NetworkManager.getThreadCount(); ++i)
+	{
+		const CNetworkThread* pThread = g_NetworkManager.getThread(i);
+
+		char tmpstring[128];
+		snprintf(tmpstring, sizeof(tmpstring), "Network thread #%" PRIuSIZE_T " = %" PRIuSIZE_T " clients, %llu bytes, %llu packets (last interval)\n",
+			pThread->id(), pThread->getClientCount(), pThread->getLoadBytes(), pThread->getLoadPackets());
+		if (pSrc != this)
+		{
+			pSrc->SysMessage(tmpstring);
+		}
+		else
+		{
+			g_Log.Event(LOGL_EVENT, tmpstring);
+		}
+		if (ftDump != nullptr)
+		{
+			ftDump->Printf(tmpstring);
+		}
+	}
+
 	if ( IsSetEF(EF_Script_Profiler) )
 	{
         if (g_profiler.initstate != 0xf1)
@@ -1327,6 +1398,45 @@ bool CServer::r_WriteVal( lpctstr ptcKey, CSString & sVal, CTextConsole * pSrc,
 		// we're trying to retrieve a property from an invalid account
 		return false;
 	}
+	else if (!strnicmp(ptcKey, "NETSTATS.", 9))
+	{
+		// NETSTATS.TX|RX[.id].COUNT|BYTES|COMPRESSED|TIME
+		ptcKey += 9;
+		NETSTATS_DIR dir;
+		if ( !strnicmp(ptcKey, "TX.", 3) )
+			dir = NETSTATS_TX;
+		else if ( !strnicmp(ptcKey, "RX.", 3) )
+			dir = NETSTATS_RX;
+		else
+			return false;
+		ptcKey += 3;
+
+		PacketStatsEntry entry;
+		if ( IsDigit(ptcKey[0]) )
+		{
+			const uint uiPacketId = Exp_GetUVal(ptcKey);
+			if ( uiPacketId > UCHAR_MAX )
+				return false;
+			SKIP_SEPARATORS(ptcKey);
+			PacketStats::getEntry(dir, (byte)uiPacketId, entry);
+		}
+		else
+		{
+			PacketStats::getTotal(dir, entry);
+		}
+
+		if ( !strcmpi(ptcKey, "COUNT") )
+			sVal.FormatULLVal(entry.count);
+		else if ( !strcmpi(ptcKey, "BYTES") )
+			sVal.FormatULLVal(entry.bytes);
+		else if ( !strcmpi(ptcKey, "COMPRESSED") )
+			sVal.FormatULLVal(entry.compressed);
+		else if ( !strcmpi(ptcKey, "TIME") )
+			sVal.FormatULLVal(entry.time);
+		else
+			return false;
+		return true;
+	}
 	else if (!strnicmp(ptcKey, "GMPAGE.", 7))
 	{
 		ptcKey += 7;
@@ -1375,6 +1485,7 @@ enum SV_TYPE
 	SV_ITEMS, //read only
 	SV_LOAD,
 	SV_LOG,
+	SV_NETSTATS,
 	SV_PRINTLISTS,
 	SV_RESPAWN,
 	SV_RESTOCK,
@@ -1414,6 +1525,7 @@ lpctstr const CServer::sm_szVerbKeys[SV_QTY+1] =
 	"ITEMS", // read only
 	"LOAD",
 	"LOG",
+	"NETSTATS",
 	"PRINTLISTS",
 	"RESPAWN",
 	"RESTOCK",
@@ -1845,6 +1957,41 @@ bool CServer::r_Verb( CScript &s, CTextConsole * pSrc )
 			}
 			break;
 
+		case SV_NETSTATS:	// "NETSTATS" [RESET]
+			{
+				if ( ! strcmpi( s.GetArgStr(), "reset" ) )
+				{
+					PacketStats::reset();
+					pSrc->SysMessage("Network statistics cleared.\n");
+					break;
+				}
+
+				if ( !g_Cfg.m_fNetworkStats )
+					pSrc->SysMessage("Network statistics are disabled (NetworkStats=0), showing the last values collected.\n");
+
+				static lpctstr const sm_szDir[NETSTATS_DIR_QTY] = { "TX", "RX" };
+				for ( int dir = 0; dir < NETSTATS_DIR_QTY; ++dir )
+				{
+					PacketStatsEntry total;
+					PacketStats::getTotal(static_cast<NETSTATS_DIR>(dir), total);
+					pSrc->SysMessagef("%s total: %llu packets, %llu bytes (%llu on the wire), %llu us.\n",
+						sm_szDir[dir], total.count, total.bytes, total.compressed, total.time);
+
+					for ( uint i = 0; i <= UCHAR_MAX; ++i )
+					{
+						PacketStatsEntry entry;
+						PacketStats::getEntry(static_cast<NETSTATS_DIR>(dir), (byte)i, entry);
+						if ( entry.count == 0 )
+							continue;
+
+						pSrc->SysMessagef("%s 0x%02x: %llu packets, %llu bytes (%llu on the wire), %llu us (%.1f%% of bytes).\n",
+							sm_szDir[dir], i, entry.count, entry.bytes, entry.compressed, entry.time,
+							(total.compressed > 0) ? ((entry.compressed * 100.0) / total.compressed) : 0.0);
+					}
+				}
+			}
+			break;
+
 		case SV_VARLIST:
 			if ( ! strcmpi( s.GetArgStr(), "log" ) )
 				pSrc = &g_Serv;
@@ -2087,6 +2234,12 @@ bool CServer::SocketsInit( CSocket & socket )
 	if(socket.SetSockOpt(SO_REUSEADDR, (char *)&onNotOff , sizeof(onNotOff )) == -1) {
 		g_Log.Event(LOGL_FATAL|LOGM_INIT, "Unable to set SO_REUSEADDR!\n");
 	}
+#ifdef SO_REUSEPORT
+	// every socket listening on the port needs it, the main one included
+	if ( g_Cfg.m_fNetworkReusePort && (g_Cfg.m_iNetworkThreads > 0) && (socket.SetSockOpt(SO_REUSEPORT, (char *)&onNotOff, sizeof(onNotOff)) == -1) ) {
+		g_Log.Event(LOGL_ERROR|LOGM_INIT, "Unable to set SO_REUSEPORT!\n");
+	}
+#endif
 #endif
 	// Bind to just one specific port if they say so.
 	CSocketAddress SockAddr = m_ip;
@@ -2103,7 +2256,7 @@ bool CServer::SocketsInit( CSocket & socket )
 
 #ifdef _LIBEV
 #ifdef LIBEV_REGISTERMAIN
-	if ( g_Cfg.m_fUseAsyncNetwork != 0 )
+	if ( (g_Cfg.m_fUseAsyncNetwork != 0) && (&socket == &m_SocketMain) )
 		g_NetworkEvent.registerMainsocket();
 #endif
 #endif
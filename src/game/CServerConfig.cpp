@@ -281,6 +281,7 @@ CServerConfig::CServerConfig()
 
 	m_iNetworkThreads		= 0;				// if there aren't the ini settings, by default we'll not use additional network threads
 	m_iNetworkThreadPriority= IThread::Disabled;
+	m_fNetworkReusePort		= false;
 	m_fUseAsyncNetwork		= 0;
 	m_iNetMaxPings			= 15;
 	m_iNetHistoryTTL		= 300;
@@ -289,8 +290,10 @@ CServerConfig::CServerConfig()
 	m_iNetMaxQueueSize		= 75;
 	m_fUsePacketPriorities	= false;
 	m_fUseExtraBuffer		= true;
+	m_fNetworkStats			= false;
 
 	m_iTooltipCache			= 30 * MSECS_PER_SEC;
+	m_iGumpCompressionLevel	= -1;
 	m_iTooltipMode			= TOOLTIPMODE_SENDVERSION;
 	m_iContextMenuLimit		= 15;
 
@@ -519,6 +522,7 @@ enum RC_TYPE
 	RC_GUARDSONMURDERERS,
 	RC_GUESTSMAX,
 	RC_GUILDS,
+	RC_GUMPCOMPRESSIONLEVEL,	// m_iGumpCompressionLevel
 	RC_HEARALL,
 	RC_HELPINGCRIMINALSISACRIME,// m_fHelpingCriminalsIsACrime
 	RC_HITPOINTPERCENTONREZ,	// m_iHitpointPercentOnRez
@@ -578,6 +582,8 @@ enum RC_TYPE
 	RC_MYSQLTICKS,				// m_bMySqlTicks
 	RC_MYSQLUSER,				// m_sMySqlUser
 	RC_NETTTL,					// m_iNetHistoryTTL
+	RC_NETWORKREUSEPORT,		// m_fNetworkReusePort
+	RC_NETWORKSTATS,			// m_fNetworkStats
 	RC_NETWORKTHREADPRIORITY,	// m_iNetworkThreadPriority
 	RC_NETWORKTHREADS,			// m_iNetworkThreads
 	RC_NORESROBE,
@@ -771,6 +777,7 @@ const CAssocReg CServerConfig::sm_szLoadKeys[RC_QTY+1] =
 	{ "GUARDSONMURDERERS",		{ ELEM_BOOL,	OFFSETOF(CServerConfig,m_fGuardsOnMurderers),	0 }},
 	{ "GUESTSMAX",				{ ELEM_INT,		OFFSETOF(CServerConfig,m_iGuestsMax),			0 }},
 	{ "GUILDS",					{ ELEM_VOID,	0,											0 }},
+	{ "GUMPCOMPRESSIONLEVEL",	{ ELEM_INT,		OFFSETOF(CServerConfig,m_iGumpCompressionLevel),	0 }},
 	{ "HEARALL",				{ ELEM_VOID,	0,											0 }},
 	{ "HELPINGCRIMINALSISACRIME",{ ELEM_BOOL,	OFFSETOF(CServerConfig,m_fHelpingCriminalsIsACrime),	0 }},
 	{ "HITPOINTPERCENTONREZ",	{ ELEM_INT,		OFFSETOF(CServerConfig,m_iHitpointPercentOnRez),0 }},
@@ -830,6 +837,8 @@ const CAssocReg CServerConfig::sm_szLoadKeys[RC_QTY+1] =
 	{ "MYSQLTICKS",				{ ELEM_BOOL,	OFFSETOF(CServerConfig,m_bMySqlTicks),			0 }},
 	{ "MYSQLUSER",				{ ELEM_CSTRING,	OFFSETOF(CServerConfig,m_sMySqlUser),			0 }},
 	{ "NETTTL",					{ ELEM_INT,		OFFSETOF(CServerConfig,m_iNetHistoryTTL),		0 }},
+	{ "NETWORKREUSEPORT",		{ ELEM_BOOL,	OFFSETOF(CServerConfig,m_fNetworkReusePort),	0 }},
+	{ "NETWORKSTATS",			{ ELEM_BOOL,	OFFSETOF(CServerConfig,m_fNetworkStats),		0 }},
 	{ "NETWORKTHREADPRIORITY",	{ ELEM_INT,		OFFSETOF(CServerConfig,m_iNetworkThreadPriority),	0 }},
 	{ "NETWORKTHREADS",			{ ELEM_INT,		OFFSETOF(CServerConfig,m_iNetworkThreads),		0 }},
 	{ "NORESROBE",				{ ELEM_BOOL,	OFFSETOF(CServerConfig,m_fNoResRobe),			0 }},
@@ -1244,6 +1253,12 @@ bool CServerConfig::r_LoadVal( CScript &s )
 			m_fGuardsOnMurderers = s.GetArgVal() ? true : false;
 			break;
 
+		case RC_GUMPCOMPRESSIONLEVEL:
+			m_iGumpCompressionLevel = s.GetArgVal();
+			if (m_iGumpCompressionLevel < -1 || m_iGumpCompressionLevel > 9)
+				m_iGumpCompressionLevel = -1;
+			break;
+
 		case RC_CONTEXTMENULIMIT:
 			m_iContextMenuLimit = s.GetArgVal();
 			break;
@@ -1318,6 +1333,13 @@ bool CServerConfig::r_LoadVal( CScript &s )
 			m_iTooltipCache = s.GetArgLLVal() * MSECS_PER_SEC;
 			break;
 
+		case RC_NETWORKREUSEPORT:
+			if (g_Serv.IsLoading())
+				m_fNetworkReusePort = (s.GetArgVal() != 0);
+			else
+				g_Log.EventError("The value of NetworkReusePort cannot be modified after the server has started\n");
+			break;
+
 		case RC_NETWORKTHREADS:
 			if (g_Serv.IsLoading())
 			{
@@ -2363,7 +2385,7 @@ PLEVEL_TYPE CServerConfig::GetPrivCommandLevel( lpctstr pszCmd ) const
 		--ilevel;
 		lpctstr const * pszTable = m_PrivCommands[ilevel].data();
 		int iCount = (int)m_PrivCommands[ilevel].size();
-		if ( FindTableHeadSorted( pszCmd, pszTable, iCount ) >= 0 )
+		if ( FindTableHeadSorted( pszCmd, pszTable, iCount, false ) >= 0 )	// rebuilt at every resync, can't be indexed
 			return (PLEVEL_TYPE)ilevel;
 	}
 
@@ -4483,6 +4505,7 @@ bool CServerConfig::Load( bool fResync )
 
 	// parse eventsitem
 	m_iEventsItemLink.clear();
+	CResourceLink::OnTriggersChanged();
 	if ( ! m_sEventsItem.IsEmpty() )
 	{
 		CScript script("EVENTSITEM", m_sEventsItem);
@@ -4491,6 +4514,7 @@ bool CServerConfig::Load( bool fResync )
 
 	// parse eventspet
 	m_pEventsPetLink.clear();
+	CResourceLink::OnTriggersChanged();
 	if ( ! m_sEventsPet.IsEmpty() )
 	{
 		CScript script("EVENTSPET", m_sEventsPet);
@@ -4499,6 +4523,7 @@ bool CServerConfig::Load( bool fResync )
 
 	// parse eventsplayer
 	m_pEventsPlayerLink.clear();
+	CResourceLink::OnTriggersChanged();
 	if ( ! m_sEventsPlayer.IsEmpty() )
 	{
 		CScript script("EVENTSPLAYER", m_sEventsPlayer);
@@ -508,6 +508,7 @@ public:
 	// network settings
 	uint m_iNetworkThreads;         // number of network threads to create
 	uint m_iNetworkThreadPriority;  // priority of network threads
+	bool m_fNetworkReusePort;       // each network thread accepts connections on its own listening socket
 	int	 m_fUseAsyncNetwork;        // 0=normal send, 1=async send, 2=async send for 4.0.0+ only
 	int	 m_iNetMaxPings;            // max pings before blocking an ip
 	int	 m_iNetHistoryTTL;          // time to remember an ip
@@ -516,8 +517,10 @@ public:
 	int	 m_iNetMaxQueueSize;        // max packets to hold per queue (comment out for unlimited)
 	bool m_fUsePacketPriorities;    // true to prioritise sending packets
 	bool m_fUseExtraBuffer;         // true to queue packet data in an extra buffer
+	bool m_fNetworkStats;           // true to count packets, bytes and time by packet id
 
 	int64 m_iTooltipCache;          // time in seconds to cache tooltip for.
+	int  m_iGumpCompressionLevel;   // zlib compression level of gump dialogs (-1 = zlib default)
 	int	m_iTooltipMode;             // tooltip mode (TOOLTIP_TYPE)
 	int	m_iContextMenuLimit;        // max amount of options per context menu
 
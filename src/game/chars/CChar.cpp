@@ -252,6 +252,7 @@ CChar::CChar( CREID_TYPE baseID ) :
 	m_pNPC	  = nullptr;
 	m_pRoom = nullptr;
 	_uiStatFlag = 0;
+	_TriggerMask = {};
 
 	if ( g_World.m_fSaveParity )
 		StatFlag_Set(STATF_SAVEPARITY);	// It will get saved next time.
@@ -585,6 +585,34 @@ public:
 	virtual TRIGRET_TYPE OnTrigger( lpctstr pTrigName, CTextConsole * pSrc, CScriptTriggerArgs * pArgs );
 	TRIGRET_TYPE OnTrigger( CTRIG_TYPE trigger, CTextConsole * pSrc, CScriptTriggerArgs * pArgs = nullptr );
 
+private:
+    // Triggers of all the EVENTS, TEVENTS, CHARDEF and EVENTSPET/EVENTSPLAYER OnTrigger goes through, merged:
+    //  a trigger none of them has doesn't need to go through them.
+    struct TriggerMask
+    {
+        dword m_dwTriggers[MAX_TRIGGERS_ARRAY];
+        uint m_uiGeneration;            // CResourceLink::GetTriggersGeneration() when merged (0 = never)
+        uint m_uiEventsGeneration;      // m_OEvents.GetGeneration() when merged
+        uint m_uiTEventsGeneration;     // m_TEvents.GetGeneration() of the CHARDEF when merged
+        const CCharBase * m_pCharDef;   // merged for this CHARDEF...
+        bool m_fNPC;                    // ...and this NPC/player state
+        bool m_fPlayer;
+    } _TriggerMask;
+
+    /**
+    * @brief   Can any of the events run by OnTrigger have this trigger?
+    * @param   iAction The trigger (CTRIG_TYPE), -1 for a custom one.
+    * @return  false if none has it.
+    */
+    bool HasTriggerMerged( int iAction );
+
+    /**
+    * @brief   The @charXXX trigger fired on the source of a XXX trigger.
+    * @param   iAction The trigger.
+    * @return  The @charXXX trigger, -1 if there isn't one.
+    */
+    static int GetCharTrigger( CTRIG_TYPE iAction );
+
 public:
 	// Load/Save----------------------------------
 
@@ -4104,6 +4104,76 @@ void CChar::SetTriggerActive(lpctstr trig)
     _iRunningTriggerId = -1;
 }
 
+int CChar::GetCharTrigger( CTRIG_TYPE iAction ) // static
+{
+    // No ADDTOCALLSTACK: called at every trigger.
+    static const std::vector<int> s_vCharTriggers = []() -> std::vector<int>
+    {
+        std::vector<int> vCharTriggers(CTRIG_QTY, -1);
+        for (int i = 1; i < CTRIG_QTY; ++i)
+        {
+            tchar ptcCharTrigName[TRIGGER_NAME_MAX_LEN] = "@CHAR";
+            Str_ConcatLimitNull(ptcCharTrigName + 5, sm_szTrigName[i] + 1, TRIGGER_NAME_MAX_LEN - 5);
+            vCharTriggers[i] = FindTableSorted(ptcCharTrigName, sm_szTrigName, CountOf(sm_szTrigName) - 1);
+        }
+        return vCharTriggers;
+    }();
+
+    ASSERT((iAction >= 0) && (iAction < CTRIG_QTY));
+    return s_vCharTriggers[iAction];
+}
+
+bool CChar::HasTriggerMerged( int iAction )
+{
+    ADDTOCALLSTACK("CChar::HasTriggerMerged");
+    const CCharBase* pCharDef = Char_GetDef();
+    const bool fNPC = (m_pNPC != nullptr);
+    const bool fPlayer = (m_pPlayer != nullptr);
+    if ((_TriggerMask.m_uiGeneration != CResourceLink::GetTriggersGeneration()) ||
+        (_TriggerMask.m_uiEventsGeneration != m_OEvents.GetGeneration()) || (_TriggerMask.m_uiTEventsGeneration != pCharDef->m_TEvents.GetGeneration()) ||
+        (_TriggerMask.m_pCharDef != pCharDef) || (_TriggerMask.m_fNPC != fNPC) || (_TriggerMask.m_fPlayer != fPlayer))
+    {
+        // Same events, in the same conditions, of OnTrigger.
+        memset(_TriggerMask.m_dwTriggers, 0, sizeof(_TriggerMask.m_dwTriggers));
+        for (const CResourceRef& ref : m_OEvents)
+        {
+            if (const CResourceLink* pLink = ref.GetRef())
+                pLink->MergeTriggers(_TriggerMask.m_dwTriggers);
+        }
+        if (fNPC)
+        {
+            for (const CResourceRef& ref : pCharDef->m_TEvents)
+            {
+                if (const CResourceLink* pLink = ref.GetRef())
+                    pLink->MergeTriggers(_TriggerMask.m_dwTriggers);
+            }
+            for (const CResourceRef& ref : g_Cfg.m_pEventsPetLink)
+            {
+                if (const CResourceLink* pLink = ref.GetRef())
+                    pLink->MergeTriggers(_TriggerMask.m_dwTriggers);
+            }
+        }
+        if (!fPlayer)
+            pCharDef->MergeTriggers(_TriggerMask.m_dwTriggers);
+        else
+        {
+            for (const CResourceRef& ref : g_Cfg.m_pEventsPlayerLink)
+            {
+                if (const CResourceLink* pLink = ref.GetRef())
+                    pLink->MergeTriggers(_TriggerMask.m_dwTriggers);
+            }
+        }
+
+        _TriggerMask.m_uiGeneration = CResourceLink::GetTriggersGeneration();
+        _TriggerMask.m_uiEventsGeneration = m_OEvents.GetGeneration();
+        _TriggerMask.m_uiTEventsGeneration = pCharDef->m_TEvents.GetGeneration();
+        _TriggerMask.m_pCharDef = pCharDef;
+        _TriggerMask.m_fNPC = fNPC;
+        _TriggerMask.m_fPlayer = fPlayer;
+    }
+    return CResourceLink::IsTriggerSet(_TriggerMask.m_dwTriggers, iAction);
+}
+
 // Running a trigger for chars
 // order:
 // 1) CHAR's triggers
@@ -4136,8 +4206,18 @@ TRIGRET_TYPE CChar::OnTrigger( lpctstr pszTrigName, CTextConsole * pSrc, CScript
 	// 1) Triggers installed on characters, sensitive to actions on all chars
     {
 		tchar ptcCharTrigName[TRIGGER_NAME_MAX_LEN] = "@CHAR";
-		Str_ConcatLimitNull(ptcCharTrigName + 5, pszTrigName + 1, TRIGGER_NAME_MAX_LEN - 5);
-        const CTRIG_TYPE iCharAction = (CTRIG_TYPE)FindTableSorted(ptcCharTrigName, sm_szTrigName, CountOf(sm_szTrigName) - 1);
+        CTRIG_TYPE iCharAction;
+        if (iAction > XTRIG_UNKNOWN)
+        {
+            iCharAction = (CTRIG_TYPE)GetCharTrigger(iAction);
+            if (iCharAction > XTRIG_UNKNOWN)
+                Str_CopyLimitNull(ptcCharTrigName, sm_szTrigName[iCharAction], TRIGGER_NAME_MAX_LEN);
+        }
+        else
+        {
+            Str_ConcatLimitNull(ptcCharTrigName + 5, pszTrigName + 1, TRIGGER_NAME_MAX_LEN - 5);
+            iCharAction = (CTRIG_TYPE)FindTableSorted(ptcCharTrigName, sm_szTrigName, CountOf(sm_szTrigName) - 1);
+        }
         if ((iCharAction > XTRIG_UNKNOWN) && IsTrigUsed(ptcCharTrigName))
         {
             CChar* pChar = pSrc->GetChar();
@@ -4158,7 +4238,7 @@ TRIGRET_TYPE CChar::OnTrigger( lpctstr pszTrigName, CTextConsole * pSrc, CScript
 	//
 	// Go through the event blocks for the NPC/PC to do events.
 	//
-	if ( IsTrigUsed(pszTrigName) )
+	if ( IsTrigUsed(pszTrigName) && HasTriggerMerged(iAction) )
 	{
 		fc::vector_set<const CResourceLink*> executedEvents;
 
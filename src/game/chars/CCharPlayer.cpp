@@ -85,6 +85,7 @@ bool CCharPlayer::SetSkillClass( CChar * pChar, CResourceID rid )
 
 	// set it as m_Events block as well.
     pChar->m_OEvents.push_back(pLink);
+    pChar->m_OEvents.OnChanged();
 	return true;
 }
 
@@ -618,6 +618,12 @@ bool CClient::r_WriteVal( lpctstr ptcKey, CSString & sVal, CTextConsole * pSrc,
         case CC_LASTEVENTWALK:
             sVal.FormatLLVal( m_timeLastEventWalk );
             break;
+		case CC_NETBANDWIDTH:
+			sVal.FormatSTVal( GetNetState()->getBandwidth() );
+			break;
+		case CC_NETQUEUEDBYTES:
+			sVal.FormatSTVal( GetNetState()->getQueuedBytes() );
+			break;
 		case CC_PRIVSHOW:
 			// Show my priv title.
 			sVal.FormatVal( ! IsPriv( PRIV_PRIV_NOSHOW ));
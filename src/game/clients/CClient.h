@@ -142,7 +142,7 @@ public:
 	int64 m_timeLogin;			    // World clock of login time. "LASTCONNECTTIME"
 	int64 m_timeLastEvent;		    // Last time we got event from client.
 	int64 m_timeLastEventWalk;	    // Last time we got a walk event from client
-	int64 m_timeNextEventWalk;		// Fastwalk prevention: only allow more walk requests after this timer
+	int64 m_timeNextEventWalk;		// Fastwalk prevention: only allow more walk requests received after this timer (system clock, ms)
 
     // Client-sent flags
     bool _fShowPublicHouseContent;
@@ -348,8 +348,9 @@ public:
 	void Event_VendorSell(CChar* pVendor, const VendorItem* items, uint uiItemCount);
 	void Event_VendorSell_Cheater( int iCode = 0 );
     void Event_VirtueSelect(dword dwVirtue, CChar *pCharTarg);
-	bool Event_Walk( byte rawdir, byte sequence = 0 ); // Player moves
-	bool Event_CheckWalkBuffer(byte rawdir);
+	bool Event_Walk( byte rawdir, byte sequence = 0, int64 iTimeReceived = 0 ); // Player moves
+	void Event_WalkSteps(); // Process the queued walk requests
+	bool Event_CheckWalkBuffer(byte rawdir, int64 iTimeReceived = 0);
 
 	TRIGRET_TYPE Menu_OnSelect( const CResourceID& rid, int iSelect, CObjBase * pObj );
 	TRIGRET_TYPE Dialog_OnButton( const CResourceID& rid, dword dwButtonID, CObjBase * pObj, CDialogResponseArgs * pArgs );
@@ -712,7 +712,7 @@ void CClient::Event_Skill_Use( SKILL_TYPE skill ) // Skill is clicked on the ski
 
 
 
-bool CClient::Event_CheckWalkBuffer(byte rawdir)
+bool CClient::Event_CheckWalkBuffer(byte rawdir, int64 iTimeReceived)
 {
 	ADDTOCALLSTACK("CClient::Event_CheckWalkBuffer");
 	//Return False: block the step
@@ -721,7 +721,8 @@ bool CClient::Event_CheckWalkBuffer(byte rawdir)
 	//NOTE: If WalkBuffer=20 in ini, it's egal 2000 here
 
 
-	const int64 iCurTime = CSTime::GetPreciseSysTimeMilli();
+	// queued requests are checked against the time they were received, not the time they are processed
+	const int64 iCurTime = (iTimeReceived > 0) ? iTimeReceived : CSTime::GetPreciseSysTimeMilli();
     int64 iTimeDiff = (int64)llabs(iCurTime - m_timeWalkStep);	// use absolute value to prevent overflows
 	int64 iTimeMin = 0;  // minimum time to move 1 step in milliseconds
 	m_timeWalkStep = iCurTime; //Take the time of step for the next time we enter here
@@ -806,7 +807,7 @@ bool CClient::Event_CheckWalkBuffer(byte rawdir)
 
 
 
-bool CClient::Event_Walk( byte rawdir, byte sequence ) // Player moves
+bool CClient::Event_Walk( byte rawdir, byte sequence, int64 iTimeReceived ) // Player moves
 {
 	ADDTOCALLSTACK("CClient::Event_Walk");
 	// The client is sending a walk request to server, so the server must check
@@ -848,6 +849,8 @@ bool CClient::Event_Walk( byte rawdir, byte sequence ) // Player moves
 
 		// To get milliseconds precision we must get the system clock manually at each walk request (the server clock advances only at every tick).
 		const int64 iCurTime = CWorldGameTime::GetCurrentTime().GetTimeRaw();
+		// Queued requests are checked against the time they were received: a batch processed in a single tick isn't a fastwalk.
+		const int64 iStepTime = (iTimeReceived > 0) ? iTimeReceived : CSTime::GetPreciseSysTimeMilli();
 
 		if (!m_pChar->MoveToChar(pt, false, false))
 		{
@@ -870,7 +873,7 @@ bool CClient::Event_Walk( byte rawdir, byte sequence ) // Player moves
 		if (IsSetEF(EF_FastWalkPrevention) && !m_pChar->IsPriv(PRIV_GM))
 		{
 			// FIXME:THIS SYSTEM DO NOT WORK SEE DETAIL DOWN
-			if (iCurTime < m_timeNextEventWalk)		// fastwalk detected (speedhack)
+			if (iStepTime < m_timeNextEventWalk)		// fastwalk detected (speedhack)
 			{
 				g_Log.Event(LOGL_WARN | LOGM_CHEAT, "Fastwalk detection for '%s', this player will notice a lag\n", GetAccount()->GetName());
 				new PacketMovementRej(this, sequence);
@@ -889,9 +892,9 @@ bool CClient::Event_Walk( byte rawdir, byte sequence ) // Player moves
 			// On live server, with delay of 30, some player will experience false-positive some not. Player with good ping will be able to use speedhack without detection
 			// FIXME: The offset delay should be calculate using the ping value of each player and a fix value of processor functionnality. The iDelay must ajust each tick depending of the ping
 			// The buffer system Event_CheckWalkBuffer seem more acurate because it permit some ajustment.
-			m_timeNextEventWalk = iCurTime + iDelay;
+			m_timeNextEventWalk = iStepTime + iDelay;
 		}
-		else if (m_pChar->IsStatFlag(STATF_FLY) && !m_pChar->IsPriv(PRIV_GM) && (g_Cfg.m_iWalkBuffer) && !m_pChar->GetRegion()->_pMultiLink && !Event_CheckWalkBuffer(rawdir) )
+		else if (m_pChar->IsStatFlag(STATF_FLY) && !m_pChar->IsPriv(PRIV_GM) && (g_Cfg.m_iWalkBuffer) && !m_pChar->GetRegion()->_pMultiLink && !Event_CheckWalkBuffer(rawdir, iTimeReceived) )
 				//Run, Not GM , walkbuffer active on ini, not on multi (boat) 
 		{
 			new PacketMovementRej(this, sequence);
@@ -929,6 +932,80 @@ bool CClient::Event_Walk( byte rawdir, byte sequence ) // Player moves
 	return true;
 }
 
+void CClient::Event_WalkSteps()
+{
+	ADDTOCALLSTACK("CClient::Event_WalkSteps");
+	// Process all the walk requests received since the last time, in the same order.
+	// The network thread already did the checks not depending on the world, see CNetState::queueWalkStep
+
+	CNetState *net = GetNetState();
+	CNetState::WalkStep steps[NETSTATE_MAXWALKSTEPS * 2];
+	size_t iCount = 0;
+	while ( (iCount < CountOf(steps)) && net->takeWalkStep(steps[iCount]) )
+		++iCount;
+
+	if ( iCount == 0 )
+		return;
+
+	// With network threads, the next packets of the client wait until these steps are processed (see CNetworkInput::processGameClientPackets)
+	struct WalkStepsDone_s
+	{
+		CNetState *m_pNet;
+		size_t m_iCount;
+		~WalkStepsDone_s() { m_pNet->doneWalkSteps(m_iCount); }
+	} stepsDone{ net, iCount };
+
+	if ( m_pChar )
+	{
+		// Load the map blocks along the requested path first, so the movement checks of
+		// every step will find them in the cache
+		CPointMap pt = m_pChar->GetTopPoint();
+		DIR_TYPE dirFace = m_pChar->m_dirFace;
+		int iBlockX = -1, iBlockY = -1;
+		for ( size_t i = 0; i < iCount; ++i )
+		{
+			if ( !steps[i].isValid )
+				break;
+
+			const DIR_TYPE dir = DIR_TYPE(steps[i].direction & 0x0F);
+			if ( dir != dirFace )
+			{
+				dirFace = dir;	// just a change in dir
+				continue;
+			}
+
+			pt.Move(dir);
+			if ( !pt.IsValidXY() )
+				break;
+			if ( ((pt.m_x / UO_BLOCK_SIZE) == iBlockX) && ((pt.m_y / UO_BLOCK_SIZE) == iBlockY) )
+				continue;
+
+			iBlockX = pt.m_x / UO_BLOCK_SIZE;
+			iBlockY = pt.m_y / UO_BLOCK_SIZE;
+			CWorldMap::GetMapBlock(pt);
+		}
+	}
+
+	for ( size_t i = 0; i < iCount; ++i )
+	{
+		byte direction = steps[i].direction;
+		byte sequence = steps[i].sequence;
+		if ( !steps[i].isValid || (net->m_sequence == 0 && sequence != 0) )
+			direction = DIR_QTY;	// setting invalid direction to intentionally reject the walk request
+
+		if ( Event_Walk(direction, sequence, steps[i].time) )
+		{
+			if ( sequence == UINT8_MAX )
+				sequence = 0;
+			net->m_sequence = ++sequence;
+		}
+		else
+		{
+			net->m_sequence = 0;
+		}
+	}
+}
+
 // Client selected an combat ability on book
 void CClient::Event_CombatAbilitySelect(dword dwAbility)
 {
@@ -63,12 +63,27 @@ bool CClient::addAOSTooltip(CObjBase * pObj, bool fRequested, bool fShop)
 		}
 	}
 
-	PacketPropertyList* propertyList = pObj->GetPropertyList();
+	// the cached list is shared by all the clients getting the same kind of tooltip for this object,
+	// it's dropped when a property shown in it changes (ResendTooltip) or after TooltipCache seconds
+	const bool fStaff = (GetPrivLevel() > PLEVEL_Player) || IsPriv(PRIV_GM);
+	const CObjBase::TOOLTIP_VIEW view = fNameOnly ? CObjBase::TOOLTIPVIEW_NAMEONLY : (fStaff ? CObjBase::TOOLTIPVIEW_STAFF : CObjBase::TOOLTIPVIEW_PLAYER);
+
+	// the staff lists depend on the privileges of each viewer (GM mode, plevel compared to incognito characters),
+	// like the player lists of incognito characters with a lower plevel than the viewer: never share them
+	bool fShared = fNameOnly || !fStaff;
+	if (fShared && !fNameOnly && pObj->IsChar())
+	{
+		const CChar* pCharObj = static_cast<const CChar*>(pObj);
+		if (pCharObj->IsStatFlag(STATF_INCOGNITO) && (GetPrivLevel() > pCharObj->GetPrivLevel()))
+			fShared = false;
+	}
+	PacketPropertyList* propertyList = fShared ? pObj->GetPropertyList(view) : nullptr;
 
 	if (propertyList == nullptr || propertyList->hasExpired(g_Cfg.m_iTooltipCache))
 	{
         pObj->m_TooltipData.clear();
-		pObj->FreePropertyList();
+		if (fShared)
+			pObj->SetPropertyList(nullptr, view);
 
         CClientTooltip* t = nullptr;
         CItem *pItem = pObj->IsItem() ? static_cast<CItem *>(pObj) : nullptr;
@@ -145,7 +160,7 @@ bool CClient::addAOSTooltip(CObjBase * pObj, bool fRequested, bool fShop)
             // the client will show the previous cached tooltip on the new obj. To avoid this,
             // compare both tooltip hashes to check if it really got changed, and if positive,
             // send the full tooltip instead just the revision number
-            if ( pObj->GetPropertyHash() != dwHash )
+            if ( pObj->GetPropertyHash(view) != dwHash )
                 fRequested = true;
         }
 
@@ -155,14 +170,13 @@ bool CClient::addAOSTooltip(CObjBase * pObj, bool fRequested, bool fShop)
 		//
 		// we still want to generate a hash though, so we don't have to increment
 		// the revision number if the tooltip hasn't actually been changed
-		dword revision = pObj->UpdatePropertyRevision(dwHash);
+		dword revision = pObj->UpdatePropertyRevision(dwHash, view);
 		propertyList = new PacketPropertyList(pObj, revision, pObj->m_TooltipData);
 
-		// cache the property list for next time, unless property list is
-		// incomplete (name only) or caching is disabled
-		if ((fNameOnly == false) && (g_Cfg.m_iTooltipCache > 0))
+		// cache the property list for next time, unless caching is disabled
+		if (fShared && (g_Cfg.m_iTooltipCache > 0))
 		{
-			pObj->SetPropertyList(propertyList);
+			pObj->SetPropertyList(propertyList, view);
 		}
 	}
 	
@@ -201,7 +215,7 @@ bool CClient::addAOSTooltip(CObjBase * pObj, bool fRequested, bool fShop)
 
 	// delete the original packet, as long as it doesn't belong
 	// to the object (i.e. wasn't cached)
-	if (propertyList != pObj->GetPropertyList())
+	if (propertyList != pObj->GetPropertyList(view))
 		delete propertyList;
 
     return true;
@@ -3600,7 +3600,7 @@ standard_order:
         }
     }
 
-	if ( IsTrigUsed(pszTrigName) )
+	if ( IsTrigUsed(pszTrigName) && HasTriggerMerged(iAction) )
 	{
 		//	2) EVENTS (could be modified ingame!)
         {
@@ -3721,6 +3721,19 @@ stopandret:
 	return iRet;
 }
 
+bool CItem::HasTriggerMerged( int iAction )
+{
+	ADDTOCALLSTACK("CItem::HasTriggerMerged");
+	// Most of the items have no EVENTS, or a few: look at them directly, the others are merged in the ITEMDEF.
+	for ( const CResourceRef& ref : m_OEvents )
+	{
+		const CResourceLink * pLink = ref.GetRef();
+		if ( pLink && pLink->HasTrigger(iAction) )
+			return true;
+	}
+	return Item_GetDef()->HasTriggerMerged(iAction, GetType());
+}
+
 TRIGRET_TYPE CItem::OnTrigger( ITRIG_TYPE trigger, CTextConsole * pSrc, CScriptTriggerArgs * pArgs )
 {
 	ASSERT((trigger >= 0) && (trigger < ITRIG_QTY));
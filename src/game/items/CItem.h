@@ -733,6 +733,16 @@ public:
 	TRIGRET_TYPE OnTrigger( lpctstr pszTrigName, CTextConsole * pSrc, CScriptTriggerArgs * pArgs );
 	TRIGRET_TYPE OnTrigger( ITRIG_TYPE trigger, CTextConsole * pSrc, CScriptTriggerArgs * pArgs = nullptr );
 
+private:
+	/**
+	* @brief   Can any of the events run by OnTrigger have this trigger?
+	* @param   iAction The trigger (ITRIG_TYPE), -1 for a custom one.
+	* @return  false if none has it.
+	*/
+	bool HasTriggerMerged( int iAction );
+
+public:
+
 	// Item type specific stuff.
     inline bool IsType(IT_TYPE type) const {
         return ( m_type == type );
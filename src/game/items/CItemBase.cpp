@@ -23,6 +23,7 @@ CItemBase::CItemBase( ITEMID_TYPE id ) :
 {
 	m_weight		= 0;
 	m_speed			= 0;
+	_TriggerMask	= {};
 	m_iSkill		= SKILL_NONE;
 	m_layer			= LAYER_NONE;
 	m_CanUse		= CAN_U_ALL;
@@ -175,6 +176,39 @@ void CItemBase::UnLink()
     CBaseBaseDef::UnLink();
 }
 
+bool CItemBase::HasTriggerMerged( int iAction, IT_TYPE type )
+{
+	ADDTOCALLSTACK("CItemBase::HasTriggerMerged");
+	if ( (_TriggerMask.m_uiGeneration != CResourceLink::GetTriggersGeneration()) ||
+		(_TriggerMask.m_uiTEventsGeneration != m_TEvents.GetGeneration()) || (_TriggerMask.m_type != type) )
+	{
+		// Same events, in the same order, of CItem::OnTrigger.
+		memset(_TriggerMask.m_dwTriggers, 0, sizeof(_TriggerMask.m_dwTriggers));
+		for ( const CResourceRef& ref : m_TEvents )
+		{
+			if ( const CResourceLink* pLink = ref.GetRef() )
+				pLink->MergeTriggers(_TriggerMask.m_dwTriggers);
+		}
+		for ( const CResourceRef& ref : g_Cfg.m_iEventsItemLink )
+		{
+			if ( const CResourceLink* pLink = ref.GetRef() )
+				pLink->MergeTriggers(_TriggerMask.m_dwTriggers);
+		}
+		const CResourceLink * pTypeDef = dynamic_cast <const CResourceLink *>( g_Cfg.ResourceGetDef( CResourceID( RES_TYPEDEF, type )));
+		if ( pTypeDef )
+			pTypeDef->MergeTriggers(_TriggerMask.m_dwTriggers);
+		MergeTriggers(_TriggerMask.m_dwTriggers);
+
+		_TriggerMask.m_uiGeneration = CResourceLink::GetTriggersGeneration();
+		_TriggerMask.m_uiTEventsGeneration = m_TEvents.GetGeneration();
+		_TriggerMask.m_type = type;
+		_TriggerMask.m_fTypeDef = (pTypeDef != nullptr);
+	}
+
+	// Without a TYPEDEF, OnTrigger must go on to report it (and fix the type).
+	return !_TriggerMask.m_fTypeDef || CResourceLink::IsTriggerSet(_TriggerMask.m_dwTriggers, iAction);
+}
+
 void CItemBase::CopyBasic( const CItemBase * pBase )
 {
 	ADDTOCALLSTACK("CItemBase::CopyBasic");
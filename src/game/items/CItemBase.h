@@ -29,6 +29,18 @@ private:
 	byte    m_layer;			// Is this item equippable on paperdoll? LAYER=LAYER_TYPE defaults from the .MUL file.
 	uint64  m_qwFlags;			//  UFLAG4_DOOR from CUOItemTypeRec/CUOItemTypeRec_HS
 	byte	m_speed;
+
+	// Triggers of the TEVENTS, EVENTSITEM, TYPEDEF and ITEMDEF CItem::OnTrigger goes through, merged once for all the
+	//  items of this ITEMDEF (their own EVENTS are checked by CItem::HasTriggerMerged).
+	struct TriggerMask
+	{
+		dword m_dwTriggers[MAX_TRIGGERS_ARRAY];
+		uint m_uiGeneration;			// CResourceLink::GetTriggersGeneration() when merged (0 = never)
+		uint m_uiTEventsGeneration;		// m_TEvents.GetGeneration() when merged
+		IT_TYPE m_type;					// merged for the TYPEDEF of this type...
+		bool m_fTypeDef;				// ...which exists
+	} _TriggerMask;
+
 public:
 	static const char *m_sClassName;
 	SKILL_TYPE m_iSkill;
@@ -339,6 +351,14 @@ public:
 	void CopyBasic( const CItemBase * pBase );
 	void CopyTransfer( CItemBase * pBase );
 
+	/**
+	* @brief   Can the TEVENTS, EVENTSITEM, TYPEDEF or ITEMDEF run by CItem::OnTrigger have this trigger?
+	* @param   iAction The trigger (ITRIG_TYPE), -1 for a custom one.
+	* @param   type    The type of the item (it chooses the TYPEDEF).
+	* @return  false if none has it.
+	*/
+	bool HasTriggerMerged( int iAction, IT_TYPE type );
+
 public:
 	explicit CItemBase( ITEMID_TYPE id );
 	virtual ~CItemBase();
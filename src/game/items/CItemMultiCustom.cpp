@@ -1004,8 +1004,25 @@ void CItemMultiCustom::SendStructureTo(CClient * pClientSrc)
             if (fFoundItems == false)
                 continue;
 
-            int iPlaneSize = (iMaxIndex + 1) * sizeof(nword);
-            cmd->writePlaneData(iCurrentPlane, iItemCount, (byte*)wPlaneBuffer, iPlaneSize);
+            // only planes that changed since the last packet built for this design need to be compressed again,
+            // while customizing usually a single plane is edited between two revisions
+            const int iPlaneSize = (iMaxIndex + 1) * sizeof(nword);
+            const byte* pPlaneData = reinterpret_cast<const byte*>(wPlaneBuffer);
+            if ((int)pDesign->m_vectorPlanes.size() <= iCurrentPlane)
+                pDesign->m_vectorPlanes.resize(iCurrentPlane + 1);
+
+            CDesignPlane& plane = pDesign->m_vectorPlanes[iCurrentPlane];
+            if (plane.m_vectorCompressed.empty() || (plane.m_vectorData.size() != (size_t)iPlaneSize) || memcmp(plane.m_vectorData.data(), pPlaneData, iPlaneSize) != 0)
+            {
+                plane.m_vectorData.assign(pPlaneData, pPlaneData + iPlaneSize);
+                if (!cmd->compressPlaneData(iCurrentPlane, pPlaneData, iPlaneSize, plane.m_vectorCompressed))
+                {
+                    plane.m_vectorData.clear();
+                    continue;
+                }
+            }
+
+            cmd->writeCompressedPlaneData(iCurrentPlane, iItemCount, iPlaneSize, plane.m_vectorCompressed.data(), (int)plane.m_vectorCompressed.size());
         }
 
         for (const CMultiComponent* pComp : vectorStairs)
@@ -1298,6 +1315,9 @@ void CItemMultiCustom::CopyDesign(CDesignDetails * designFrom, CDesignDetails *
         designTo->m_pData = nullptr;
         designTo->m_iDataRevision = 0;
     }
+
+    // compressed planes are checked against their data before being reused, so they can be shared
+    designTo->m_vectorPlanes = designFrom->m_vectorPlanes;
 }
 
 void CItemMultiCustom::GetLockdownsAt(short dx, short dy, char dz, std::vector<CUID> &vList)
@@ -25,12 +25,19 @@ public:
     };
 
 private:
+    struct CDesignPlane
+    {
+        std::vector<byte> m_vectorData;         // plane data the compressed data has been made from
+        std::vector<byte> m_vectorCompressed;   // compressed plane data, reused until the plane changes
+    };
+
     struct CDesignDetails
     {
         int m_iRevision;
         std::vector<CMultiComponent*> m_vectorComponents;
         PacketHouseDesign* m_pData;
         int m_iDataRevision;
+        std::vector<CDesignPlane> m_vectorPlanes;   // compressed planes of the last packet built
     };
 
     class CSphereMultiCustom : public CUOMulti
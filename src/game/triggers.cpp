@@ -1,5 +1,6 @@
 
 #include <vector>
+#include "../common/parallel_hashmap/phmap.h"
 #include "../common/CLog.h"
 #include "CServer.h"
 #include "triggers.h"
@@ -12,6 +13,13 @@ struct T_TRIGGERS
     int		m_used;
 };
 std::vector<T_TRIGGERS> g_triggers;
+phmap::flat_hash_map<std::string_view, size_t, StrViewHashI_s, StrViewEqualI_s> g_triggersIndex;  // g_triggers position of each name
+
+static T_TRIGGERS * FindTrigger(const char *name)
+{
+    const auto it = g_triggersIndex.find(std::string_view(name));
+    return (it == g_triggersIndex.end()) ? nullptr : &g_triggers[it->second];
+}
 
 bool IsTrigUsed(E_TRIGGERS id)
 {
@@ -24,11 +32,9 @@ bool IsTrigUsed(const char *name)
 {
     if ( g_Serv.IsLoading() == true)
         return false;
-    for ( auto it = g_triggers.cbegin(), end = g_triggers.cend(); it != end; ++it )
-    {
-        if ( !strcmpi(it->m_name, name) )
-            return (it->m_used != 0); // Returns true or false for known triggers
-    }
+    const T_TRIGGERS *pTrig = FindTrigger(name);
+    if ( pTrig )
+        return (pTrig->m_used != 0); // Returns true or false for known triggers
     return true; //Must return true for custom triggers
 }
 
@@ -40,6 +46,11 @@ void TriglistInit()
 #define ADD(_a_)	snprintf(trig.m_name, TRIGGER_NAME_MAX_LEN, "@%s", #_a_); trig.m_used = 0; g_triggers.emplace_back(trig);
 #include "../tables/triggers.tbl"
 #undef ADD
+
+    g_triggersIndex.clear();
+    g_triggersIndex.reserve(g_triggers.size());
+    for ( size_t i = 0; i < g_triggers.size(); ++i )
+        g_triggersIndex.try_emplace(std::string_view(g_triggers[i].m_name), i);
 }
 
 void TriglistClear()
@@ -58,14 +69,9 @@ void TriglistAdd(E_TRIGGERS id)
 
 void TriglistAdd(const char *name)
 {
-    for ( auto it = g_triggers.begin(), end = g_triggers.end(); it != end; ++it )
-    {
-        if ( !strcmpi(it->m_name, name) )
-        {
-            ++ it->m_used;
-            break;
-        }
-    }
+    T_TRIGGERS *pTrig = FindTrigger(name);
+    if ( pTrig )
+        ++ pTrig->m_used;
 }
 
 void Triglist(int &total, int &used)
@@ -5,7 +5,7 @@
 #include "CIPHistoryManager.h"
 
 #define NETHISTORY_TTL			g_Cfg.m_iNetHistoryTTL			// time to remember an ip
-#define NETHISTORY_PINGDECAY	60								// time to decay 1 'ping'
+#define NETHISTORY_PINGDECAY_MS	(60 * MSECS_PER_SEC)			// time to decay 1 'ping'
 
 
 /***************************************************************************
@@ -18,7 +18,21 @@
 void HistoryIP::update(void)
 {
     // reset ttl
-    m_ttl = NETHISTORY_TTL;
+    m_ttlExpire = CWorldGameTime::GetCurrentTime().GetTimeRaw() + ((int64)NETHISTORY_TTL * MSECS_PER_SEC);
+}
+
+void HistoryIP::decay(int64 iTimeNow)
+{
+    // pings are forgotten lazily, all those whose time has passed at once
+    if (m_pings > 0 && iTimeNow >= m_pingDecay)
+    {
+        const int64 iDecayed = 1 + ((iTimeNow - m_pingDecay) / NETHISTORY_PINGDECAY_MS);
+        m_pings = (iDecayed >= m_pings) ? 0 : (m_pings - (int)iDecayed);
+        m_pingDecay += iDecayed * NETHISTORY_PINGDECAY_MS;
+    }
+
+    if (m_blocked && m_blockExpire > 0 && iTimeNow > m_blockExpire)
+        setBlocked(false);
 }
 
 bool HistoryIP::checkPing(void)
@@ -26,6 +40,9 @@ bool HistoryIP::checkPing(void)
     // ip is pinging, check if blocked
     update();
 
+    if (m_pings <= 0)
+        m_pingDecay = CWorldGameTime::GetCurrentTime().GetTimeRaw() + NETHISTORY_PINGDECAY_MS;
+
     return (m_blocked || (m_pings++ >= g_Cfg.m_iNetMaxPings));
 }
 
@@ -58,7 +75,6 @@ void HistoryIP::setBlocked(bool isBlocked, int timeout)
  ***************************************************************************/
 IPHistoryManager::IPHistoryManager(void)
 {
-    m_lastDecayTime = 0;
 }
 
 IPHistoryManager::~IPHistoryManager(void)
@@ -71,68 +87,85 @@ void IPHistoryManager::tick(void)
     // periodic events
     ADDTOCALLSTACK("IPHistoryManager::tick");
 
-    // check if ttl should decay (only do this once every second)
-    bool decayTTL = (!(m_lastDecayTime > 0) || CWorldGameTime::GetCurrentTime().GetTimeDiff(m_lastDecayTime) > MSECS_PER_SEC);
-    if (decayTTL)
-        m_lastDecayTime = CWorldGameTime::GetCurrentTime().GetTimeRaw();
-
-    for (IPHistoryList::iterator it = m_ips.begin(), end = m_ips.end(); it != end; ++it)
+    // only the ips due for a check are visited: blocks expire, and ips which aren't in use
+    // anymore are forgotten once their ttl has passed
+    const int64 iTimeNow = CWorldGameTime::GetCurrentTime().GetTimeRaw();
+    while (m_expiry.empty() == false && m_expiry.top().first <= iTimeNow)
     {
-        if (it->m_blocked)
+        const dword dwIP = m_expiry.top().second;
+        m_expiry.pop();
+
+        const auto itIndex = m_index.find(dwIP);
+        if (itIndex == m_index.end())
+            continue;
+
+        HistoryIP& hist = m_ips[itIndex->second];
+        hist.decay(iTimeNow);
+
+        int64 iNextCheck;
+        if (hist.m_blocked)
         {
-            // blocked ips don't decay, but check if the ban has expired
-            if (it->m_blockExpire > 0 && (CWorldGameTime::GetCurrentTime().GetTimeRaw() > it->m_blockExpire))
-                it->setBlocked(false);
+            // blocked ips are never forgotten
+            iNextCheck = (hist.m_blockExpire > 0) ? hist.m_blockExpire + 1 : iTimeNow + ((int64)NETHISTORY_TTL * MSECS_PER_SEC);
         }
-        else if (decayTTL)
+        else if (hist.m_connected > 0 || hist.m_connecting > 0)
         {
-            if (it->m_connected == 0 && it->m_connecting == 0)
-            {
-                // start to forget about clients who aren't connected
-                if (it->m_ttl >= 0)
-                    --it->m_ttl;
-            }
-
-            // wait a 5th of TTL between each ping decay, but do not wait less than 30 seconds
-            if (it->m_pings > 0 && --it->m_pingDecay < 0)
-            {
-                --it->m_pings;
-                it->m_pingDecay = NETHISTORY_PINGDECAY;
-            }
+            // start to forget about clients once they aren't connected anymore
+            hist.update();
+            iNextCheck = hist.m_ttlExpire;
         }
-    }
-
-    // clear old ip history
-    for (IPHistoryList::iterator it = m_ips.begin(), end = m_ips.end(); it != end; ++it)
-    {
-        if (it->m_ttl >= 0)
+        else if (hist.m_ttlExpire > iTimeNow)
+        {
+            iNextCheck = hist.m_ttlExpire;
+        }
+        else
+        {
+            // clear old ip history
+            m_freeSlots.emplace_back(itIndex->second);
+            m_index.erase(itIndex);
             continue;
+        }
 
-        m_ips.erase(it);
-        break;
+        m_expiry.emplace(iNextCheck, dwIP);
     }
 }
 
 HistoryIP& IPHistoryManager::getHistoryForIP(const CSocketAddressIP& ip) noexcept
 {
     // get history for an ip
+    const int64 iTimeNow = CWorldGameTime::GetCurrentTime().GetTimeRaw();
 
     // find existing entry
-    for (IPHistoryList::iterator it = m_ips.begin(), end = m_ips.end(); it != end; ++it)
+    const dword dwIP = ip.GetAddrIP();
+    const auto itIndex = m_index.find(dwIP);
+    if (itIndex != m_index.end())
     {
-        if (it->m_ip == ip)
-            return *it;
+        HistoryIP& hist = m_ips[itIndex->second];
+        hist.decay(iTimeNow);
+        return hist;
     }
 
     // create a new entry
-    HistoryIP hist = {};
+    size_t uiSlot;
+    if (m_freeSlots.empty())
+    {
+        uiSlot = m_ips.size();
+        m_ips.emplace_back();
+    }
+    else
+    {
+        uiSlot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    HistoryIP& hist = m_ips[uiSlot];
+    hist = {};
     hist.m_ip = ip;
-    hist.m_pingDecay = NETHISTORY_PINGDECAY;
     hist.update();
 
-    m_ips.emplace_back(std::move(hist));
-
-    return getHistoryForIP(ip);
+    m_index.emplace(dwIP, uiSlot);
+    m_expiry.emplace(hist.m_ttlExpire, dwIP);
+    return hist;
 }
 
 HistoryIP& IPHistoryManager::getHistoryForIP(const char* ip)
@@ -6,8 +6,11 @@
 #ifndef _INC_CIPHISTORYMANAGER_H
 #define _INC_CIPHISTORYMANAGER_H
 
+#include "../common/parallel_hashmap/phmap.h"
 #include "CSocket.h"
 #include <deque>
+#include <queue>
+#include <vector>
 
 
 /***************************************************************************
@@ -20,15 +23,16 @@
 struct HistoryIP
 {
     CSocketAddressIP m_ip;
-    int m_pings;
+    int m_pings;            // connection attempts, one is forgotten every minute (token bucket of MaxPings tokens)
     int m_connecting;
     int m_connected;
     bool m_blocked;
-    int m_ttl;
+    int64 m_ttlExpire;      // time when the ip can be forgotten, unless it is still in use
     int64 m_blockExpire;
-    int m_pingDecay;
+    int64 m_pingDecay;      // time when the next ping is forgotten
 
     void update(void);
+    void decay(int64 iTimeNow); // forget old pings and expired block
     bool checkPing(void); // IP is blocked -or- too many pings to it?
     void setBlocked(bool isBlocked, int timeout = -1); // timeout in seconds
 };
@@ -47,8 +51,13 @@ typedef std::deque<HistoryIP> IPHistoryList;
 class IPHistoryManager
 {
 private:
-    IPHistoryList m_ips;		// list of known ips
-    int64 m_lastDecayTime;	// last decay time
+    typedef std::pair<int64, dword> IPHistoryExpiry;
+    typedef std::priority_queue<IPHistoryExpiry, std::vector<IPHistoryExpiry>, std::greater<IPHistoryExpiry>> IPHistoryExpiryQueue;
+
+    IPHistoryList m_ips;						// known ips (slots are reused, so references stay valid until the ip is forgotten)
+    std::vector<size_t> m_freeSlots;			// unused slots in m_ips
+    phmap::flat_hash_map<dword, size_t> m_index;	// ip -> slot in m_ips
+    IPHistoryExpiryQueue m_expiry;				// when each ip has to be checked next, earliest first
 
 public:
     IPHistoryManager(void);
@@ -26,6 +26,8 @@ CNetState::CNetState(int id)
     m_outgoing.pendingTransaction = nullptr;
     m_incoming.buffer = nullptr;
     m_incoming.rawBuffer = nullptr;
+    m_incoming.isHeldForWalk = false;
+    m_walkStepsPending = 0;
     m_packetExceptions = 0;
     m_clientType = CLIENTTYPE_2D;
     m_clientVersion = 0;
@@ -104,12 +106,6 @@ void CNetState::clear(void)
     // empty queues
     clearQueues();
 
-    // clean junk queue entries
-    for (int i = 0; i < PacketSend::PRI_QTY; ++i)
-        m_outgoing.queue[i].clean();
-    m_outgoing.asyncQueue.clean();
-    m_incoming.rawPackets.clean();
-
     if (m_outgoing.currentTransaction != nullptr)
     {
         delete m_outgoing.currentTransaction;
@@ -134,7 +130,15 @@ void CNetState::clear(void)
         m_incoming.rawBuffer = nullptr;
     }
 
+    m_incoming.isHeldForWalk = false;
+
+    WalkStep step;
+    while (takeWalkStep(step))
+        ;
+    m_walkStepsPending = 0;
+
     m_sequence = 0;
+    m_walkSequence = 0;
     m_seeded = false;
     m_newseed = false;
     m_seed = 0;
@@ -142,6 +146,14 @@ void CNetState::clear(void)
     m_clientType = CLIENTTYPE_2D;
     m_isSendingAsync = false;
     m_packetExceptions = 0;
+    m_outgoing.queuedBytes = 0;
+    m_outgoing.sentBytes = 0;
+    m_outgoing.sampleTime = 0;
+    m_outgoing.bandwidth = 0;
+    m_ioBytes = 0;
+    m_ioPackets = 0;
+    m_lastLoad = 0;
+    m_migrateTo = nullptr;
     setAsyncMode(false);
     m_isInUse = false;
 }
@@ -160,6 +172,15 @@ void CNetState::clearQueues(void)
         }
     }
 
+    // clear held transactions
+    for (size_t i = 0; i < PacketSend::PRI_QTY; i++)
+    {
+        for (PacketTransaction* transaction : m_outgoing.held[i])
+            delete transaction;
+        m_outgoing.held[i].clear();
+    }
+    m_outgoing.heldCount = 0;
+
     // clear async queue
     while (m_outgoing.asyncQueue.empty() == false)
     {
@@ -169,13 +190,11 @@ void CNetState::clearQueues(void)
 
     // clear byte queue
     m_outgoing.bytes.Empty();
+    m_outgoing.queuedBytes = 0;
 
-    // clear received queue
-    while (m_incoming.rawPackets.empty() == false)
-    {
-        delete m_incoming.rawPackets.front();
-        m_incoming.rawPackets.pop();
-    }
+    // forget supersedable packets
+    for (size_t i = 0; i < NETSTATE_COALESCESLOTS; ++i)
+        m_outgoing.coalesce[i].store(0, std::memory_order_relaxed);
 }
 
 void CNetState::init(SOCKET socket, CSocketAddress addr)
@@ -298,6 +317,10 @@ bool CNetState::hasPendingData(void) const
             return true;
     }
 
+    // check held transactions
+    if (isClosing() == false && m_outgoing.heldCount > 0)
+        return true;
+
     // check async data
     if (isAsyncMode() && m_outgoing.asyncQueue.empty() == false)
         return true;
@@ -327,6 +350,178 @@ bool CNetState::canReceive(PacketSend* packet) const
     return true;
 }
 
+// Supersedable packets are tracked in a small table indexed by a hash of (packet id, uid): each slot holds the
+// key and the generation of the latest packet queued for it. Producers bump the generation when queuing, the
+// network thread drops a packet whose generation is no longer the latest and frees the slot once the latest is sent.
+// Keys colliding with an occupied slot are simply not tracked.
+#define NETSTATE_COALESCEGENBITS	24
+#define NETSTATE_COALESCEGENMASK	((1ull << NETSTATE_COALESCEGENBITS) - 1)
+
+static inline ullong GetCoalesceKey(byte packetId, dword uid)
+{
+    return ((ullong)uid << 8) | packetId;
+}
+
+static inline size_t GetCoalesceSlot(byte packetId, dword uid)
+{
+    return (size_t)(((uid * 2654435761u) >> 8) ^ packetId) & (NETSTATE_COALESCESLOTS - 1);
+}
+
+dword CNetState::markSupersedable(byte packetId, dword uid)
+{
+    ADDTOCALLSTACK("CNetState::markSupersedable");
+    if (uid == 0)
+        return 0;
+
+    const ullong key = GetCoalesceKey(packetId, uid);
+    std::atomic<ullong>& slot = m_outgoing.coalesce[GetCoalesceSlot(packetId, uid)];
+
+    ullong current = slot.load(std::memory_order_acquire);
+    for (;;)
+    {
+        dword generation;
+        if (current == 0)
+            generation = 1;
+        else if ((current >> NETSTATE_COALESCEGENBITS) == key)
+        {
+            generation = (dword)((current + 1) & NETSTATE_COALESCEGENMASK);
+            if (generation == 0)
+                generation = 1;
+        }
+        else
+            return 0; // slot taken by another object
+
+        if (slot.compare_exchange_weak(current, (key << NETSTATE_COALESCEGENBITS) | generation, std::memory_order_acq_rel))
+            return generation;
+    }
+}
+
+bool CNetState::isSuperseded(byte packetId, dword uid, dword generation)
+{
+    ADDTOCALLSTACK("CNetState::isSuperseded");
+    if (generation == 0)
+        return false;
+
+    const ullong key = GetCoalesceKey(packetId, uid);
+    std::atomic<ullong>& slot = m_outgoing.coalesce[GetCoalesceSlot(packetId, uid)];
+
+    ullong current = slot.load(std::memory_order_acquire);
+    if ((current >> NETSTATE_COALESCEGENBITS) != key)
+        return false;
+
+    if ((dword)(current & NETSTATE_COALESCEGENMASK) != generation)
+        return true;
+
+    // this is the latest packet for the key, release the slot (if a newer one was queued meanwhile, it keeps it)
+    slot.compare_exchange_strong(current, 0, std::memory_order_acq_rel);
+    return false;
+}
+
+void CNetState::sampleBandwidth(void)
+{
+    ADDTOCALLSTACK("CNetState::sampleBandwidth");
+    const llong now = CSTime::GetPreciseSysTimeMilli();
+    if (m_outgoing.sampleTime == 0)
+    {
+        m_outgoing.sampleTime = now;
+        return;
+    }
+
+    const llong elapsed = now - m_outgoing.sampleTime;
+    if (elapsed < NETSTATE_BANDWIDTHSAMPLE)
+        return;
+
+    // moving average of the send rate, only sampled whilst there is data waiting so that an idle client is not
+    // mistaken for a slow one
+    if (m_outgoing.sentBytes > 0 || m_outgoing.bytes.GetDataQty() > 0)
+    {
+        const size_t rate = (size_t)((m_outgoing.sentBytes * 1000) / elapsed);
+        if (m_outgoing.bandwidth == 0)
+            m_outgoing.bandwidth = rate;
+        else
+            m_outgoing.bandwidth = ((m_outgoing.bandwidth * 3) + rate) / 4;
+    }
+
+    m_outgoing.sentBytes = 0;
+    m_outgoing.sampleTime = now;
+}
+
+bool CNetState::isCongested(void) const
+{
+    // data is only left in the byte queue when the socket refused it
+    const size_t unsent = m_outgoing.bytes.GetDataQty();
+    if (unsent <= NETSTATE_CONGESTIONMIN)
+        return false;
+
+    return unsent > (m_outgoing.bandwidth * NETSTATE_CONGESTIONTIME) / 1000;
+}
+
+size_t CNetState::getQueuedBytes(void) const
+{
+    const llong queued = m_outgoing.queuedBytes.load(std::memory_order_relaxed);
+    return (queued > 0 ? (size_t)queued : 0) + m_outgoing.bytes.GetDataQty();
+}
+
+bool CNetState::canMigrate(void) const
+{
+    // output must be at a flush boundary: nothing half sent, nothing pending in async operations
+    if (isSendingAsync() || m_outgoing.currentTransaction != nullptr)
+        return false;
+
+    if (m_outgoing.asyncQueue.empty() == false || m_outgoing.bytes.GetDataQty() > 0)
+        return false;
+
+    return true;
+}
+
+void CNetState::queueWalkStep(byte direction, byte sequence)
+{
+    ADDTOCALLSTACK("CNetState::queueWalkStep");
+    // the checks not depending on the world are done here, so requests that would be
+    // rejected anyway don't cost anything more than a reject packet on the world thread.
+    // m_walkSequence follows the client sequence assuming every step will be accepted:
+    // if it's 0 the world side will be 0 too, so a non zero sequence can be rejected early
+    WalkStep step;
+    step.direction = direction;
+    step.sequence = sequence;
+    step.time = CSTime::GetPreciseSysTimeMilli();
+    step.isValid = ((direction & 0x0F) < DIR_QTY) && (m_walkSequence != 0 || sequence == 0);
+
+    const size_t pending = m_walkSteps.size();
+    if (pending >= NETSTATE_MAXWALKSTEPS)
+    {
+        // more requests than any client sends ahead of the server answers, the world is
+        // busy or the client is flooding: reject them. Past twice the limit (the ring is full, the step
+        // goes to its overflow list) only one reject is queued: the client drops its pending steps when
+        // it gets it, and the following requests are rejected anyway until it restarts from sequence 0
+        // (that one is always answered, the client sends it only after receiving a reject)
+        step.isValid = false;
+        if ((pending >= (NETSTATE_MAXWALKSTEPS * 2)) && (m_walkSequence == 0) && (sequence != 0))
+        {
+            DEBUGNETWORK(("%x:Walk request dropped, too many pending and a reject is already queued.\n", id()));
+            return;
+        }
+    }
+
+    if (step.isValid)
+        m_walkSequence = (sequence == UINT8_MAX) ? 1 : (byte)(sequence + 1);
+    else
+        m_walkSequence = 0;
+
+    m_walkSteps.push(step);
+    m_walkStepsPending.fetch_add(1, std::memory_order_release);
+}
+
+bool CNetState::takeWalkStep(WalkStep& step)
+{
+    if (m_walkSteps.empty())
+        return false;
+
+    step = m_walkSteps.front();
+    m_walkSteps.pop();
+    return true;
+}
+
 void CNetState::beginTransaction(int priority)
 {
     ADDTOCALLSTACK("CNetState::beginTransaction");
@@ -6,6 +6,8 @@
 #ifndef _INC_CNETSTATE_H
 #define _INC_CNETSTATE_H
 
+#include <atomic>
+#include <deque>
 #include "../common/sphere_library/CSQueue.h"
 #include "../common/sphereproto.h"
 #include "../sphere/containers.h"
@@ -17,6 +19,13 @@
 #endif
 
 
+#define NETSTATE_COALESCESLOTS	64	// max number of (packet id, object uid) keys tracked at once for coalescing (power of 2)
+#define NETSTATE_BANDWIDTHSAMPLE	250		// interval between bandwidth samples (ms)
+#define NETSTATE_CONGESTIONTIME		250		// unsent data the client needs longer than this to receive means congestion (ms)
+#define NETSTATE_CONGESTIONMIN		8192	// min unsent bytes before a client can be considered congested
+#define NETSTATE_MAXWALKSTEPS		8		// max walk requests waiting to be processed, further ones are rejected (flood)
+
+
 #ifdef DEBUGPACKETS
     #define DEBUGNETWORK(_x_)	g_Log.EventDebug _x_;
 #else
@@ -56,7 +65,6 @@ protected:
     WSAOVERLAPPED m_overlapped; // Winsock Overlapped structure
 #endif
 
-    typedef ThreadSafeQueue<Packet*> PacketQueue;
     typedef ThreadSafeQueue<PacketSend*> PacketSendQueue;
     typedef ThreadSafeQueue<PacketTransaction*> PacketTransactionQueue;
 
@@ -68,17 +76,46 @@ protected:
 
         PacketTransaction* currentTransaction;			// transaction currently being processed
         ExtendedPacketTransaction* pendingTransaction;	// transaction being built
+
+        std::atomic<ullong> coalesce[NETSTATE_COALESCESLOTS];	// latest generation queued for each supersedable packet key (key << 24 | generation)
+
+        std::deque<PacketTransaction*> held[PacketSend::PRI_QTY];	// transactions held back whilst congested (network thread only)
+        std::atomic<size_t> heldCount;		// number of held transactions
+        std::atomic<llong> queuedBytes;		// length of the packets waiting to be sent
+
+        size_t sentBytes;	// bytes sent since the last bandwidth sample
+        llong sampleTime;	// time of the last bandwidth sample
+        size_t bandwidth;	// estimated bandwidth (bytes per second)
     } m_outgoing; // outgoing data
 
     struct
     {
-        Packet* buffer; // received data
-        PacketQueue rawPackets; // raw data packets
-        Packet* rawBuffer;		// received data
+        Packet* buffer;		// decrypted data
+        Packet* rawBuffer;	// received data
+        bool isHeldForWalk;	// the packets left in buffer wait for the queued walk requests to be processed (network thread only)
     } m_incoming; // incoming data
 
     int m_packetExceptions; // number of packet exceptions
 
+    std::atomic<ullong> m_ioBytes;		// bytes received and sent since the last load check
+    std::atomic<ullong> m_ioPackets;	// packets received and sent since the last load check
+    ullong m_lastLoad;					// bytes received and sent during the last load check interval (main thread)
+    std::atomic<CNetworkThread*> m_migrateTo;	// thread to hand this state over to, once no output is in progress
+
+public:
+    struct WalkStep
+    {
+        byte direction;		// raw direction (0x80 = running)
+        byte sequence;		// client movement sequence
+        bool isValid;		// false if the request already failed the network thread checks
+        llong time;			// time the request has been received (ms)
+    };
+
+private:
+    ThreadSafeQueue<WalkStep, NETSTATE_MAXWALKSTEPS * 2> m_walkSteps;	// walk requests waiting to be processed by the world thread
+    std::atomic<size_t> m_walkStepsPending;	// walk requests queued and not fully processed yet by the world thread
+    byte m_walkSequence;			// movement sequence expected by the network thread (network thread only)
+
 public:
     GAMECLIENT_TYPE m_clientType;	// type of client
     dword m_clientVersion;			// client version (encryption)
@@ -103,6 +140,13 @@ public:
     bool isInUse(const CClient* client = nullptr) const volatile; // does this socket still belong to this/a client?
     bool hasPendingData(void) const;			// is there any data waiting to be sent?
     bool canReceive(PacketSend* packet) const;	// can the state receive the given packet?
+    dword markSupersedable(byte packetId, dword uid);	// remember a newly queued supersedable packet, returns its generation (0 = not tracked)
+    bool isSuperseded(byte packetId, dword uid, dword generation);	// has a newer packet with the same id and uid been queued since?
+
+    void sampleBandwidth(void);			// update the bandwidth estimate (network thread)
+    bool isCongested(void) const;		// is the client receiving data slower than we send it?
+    size_t getBandwidth(void) const { return m_outgoing.bandwidth; }	// estimated bandwidth (bytes per second)
+    size_t getQueuedBytes(void) const;	// amount of data waiting to be sent
 
     void detectAsyncMode(void);
     void setAsyncMode(bool isAsync) { m_useAsync = isAsync; };	// set asynchronous mode
@@ -140,6 +184,18 @@ public:
     bool isReportedLessVersion(dword version) const { return m_reportedVersion && m_reportedVersion < version; };	// check the maximum reported version
     bool isClientLessVersion(dword version) const { return isCryptLessVersion(version) || isReportedLessVersion(version); } // check the maximum client version
 
+    bool canMigrate(void) const;	// can the state be moved to another thread right now? (owning thread only)
+    void countIO(size_t bytes, size_t packets)	// account data received or sent
+    {
+        m_ioBytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_ioPackets.fetch_add(packets, std::memory_order_relaxed);
+    }
+
+    void queueWalkStep(byte direction, byte sequence);	// check and queue a walk request (receiving thread)
+    bool takeWalkStep(WalkStep& step);		// take the oldest queued walk request (main thread)
+    void doneWalkSteps(size_t count) { m_walkStepsPending.fetch_sub(count, std::memory_order_release); }	// the taken walk requests have been processed (main thread)
+    bool hasWalkSteps(void) const { return m_walkStepsPending.load(std::memory_order_acquire) != 0; }	// are there walk requests waiting to be processed, or being processed?
+
     void beginTransaction(int priority);	// begin a transaction for grouping packets
     void endTransaction(void);				// end transaction
 
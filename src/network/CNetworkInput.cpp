@@ -9,24 +9,19 @@
 #include "CNetworkManager.h"
 #include "CNetworkThread.h"
 #include "CNetworkInput.h"
+#include "CPacketStats.h"
 
-#define NETWORK_BUFFERSIZE		0xF000	// size of receive buffer
+#define NETWORK_BUFFERSIZE		0xF000	// max data to receive at once
 #define NETWORK_SEEDLEN_OLD		(sizeof( dword ))
 #define NETWORK_SEEDLEN_NEW		(1 + (sizeof( dword ) * 5))
 
 
 CNetworkInput::CNetworkInput(void) : m_thread(nullptr)
 {
-    m_receiveBuffer = new byte[NETWORK_BUFFERSIZE];
-    m_decryptBuffer = new byte[NETWORK_BUFFERSIZE];
 }
 
 CNetworkInput::~CNetworkInput()
 {
-    if (m_receiveBuffer != nullptr)
-        delete[] m_receiveBuffer;
-    if (m_decryptBuffer != nullptr)
-        delete[] m_decryptBuffer;
 }
 
 void CNetworkInput::setOwner(CNetworkThread* thread)
@@ -88,14 +83,20 @@ void CNetworkInput::receiveData()
         EXC_SET_BLOCK("start network profile");
         const ProfileTask networkTask(PROFILE_NETWORK_RX);
         if (!FD_ISSET(state->m_socket.GetSocket(), &fds))
-        {
-            state->m_incoming.rawPackets.clean();
             continue;
-        }
 
-        // receive data
+        // receive data straight after any data we didn't process yet, the whole buffer
+        // will be parsed by processData() later on this same thread
         EXC_SET_BLOCK("messages - receive");
-        int received = state->m_socket.Receive(m_receiveBuffer, NETWORK_BUFFERSIZE, 0);
+        Packet* buffer = state->m_incoming.rawBuffer;
+        if (buffer == nullptr)
+        {
+            buffer = new Packet(NETWORK_BUFFERSIZE);
+            buffer->trim();
+            state->m_incoming.rawBuffer = buffer;
+        }
+
+        int received = state->m_socket.Receive(buffer->lockAppend(NETWORK_BUFFERSIZE), NETWORK_BUFFERSIZE, 0);
         if (received <= 0 || received > NETWORK_BUFFERSIZE)
         {
             state->markReadClosed();
@@ -103,28 +104,11 @@ void CNetworkInput::receiveData()
             continue;
         }
 
+        buffer->unlockAppend((uint)received);
+        state->countIO((size_t)received, 0);
+
         EXC_SET_BLOCK("start client profile");
         CurrentProfileData.Count(PROFILE_DATA_RX, received);
-
-        EXC_SET_BLOCK("messages - parse");
-
-        // our objective here is to take the received data and separate it into packets to
-        // be stored in CNetState::m_incoming.rawPackets
-        byte* buffer = m_receiveBuffer;
-        while (received > 0)
-        {
-            // currently we just take the data and push it into a queue for the main thread
-            // to parse into actual packets
-            // todo: if possible, it would be useful to be able to perform that separation here,
-            // but this is made difficult due to the variety of client types and encryptions that
-            // may be connecting
-            uint length = (uint)received;
-
-            Packet* packet = new Packet(buffer, length);
-            state->m_incoming.rawPackets.push(packet);
-            buffer += length;
-            received -= (int)(length);
-        }
     }
 
     EXC_CATCH;
@@ -153,8 +137,17 @@ void CNetworkInput::processData()
         ASSERT(client != nullptr);
 
         EXC_SET_BLOCK("check message");
-        if (state->m_incoming.rawPackets.empty())
+        if (state->m_incoming.rawBuffer == nullptr || state->m_incoming.rawBuffer->getRemainingLength() <= 0)
         {
+            if (state->m_incoming.isHeldForWalk && (state->hasWalkSteps() == false) && (g_Serv.IsLoading() == false))
+            {
+                // the world thread processed the walk requests, the packets received after them can go on
+                EXC_SET_BLOCK("packets - resume after walk");
+                const ProfileTask clientTask(PROFILE_CLIENTS);
+                processGameClientPackets(state);
+                continue;
+            }
+
             const CONNECT_TYPE connecttype = client->GetConnectType();
             if ((connecttype != CONNECT_TELNET) && (connecttype != CONNECT_AXIS))
             {
@@ -168,37 +161,8 @@ void CNetworkInput::processData()
                 }
             }
 
-            if (state->m_incoming.rawBuffer == nullptr)
-            {
-                EXC_SET_BLOCK("next state");
-                continue;
-            }
-        }
-
-        EXC_SET_BLOCK("messages - process");
-        // we've already received some raw data, we just need to add it to any existing data we have
-        while (state->m_incoming.rawPackets.empty() == false)
-        {
-            Packet* packet = state->m_incoming.rawPackets.front();
-            state->m_incoming.rawPackets.pop();
-            ASSERT(packet != nullptr);
-
-            EXC_SET_BLOCK("packet - queue data");
-            if (state->m_incoming.rawBuffer == nullptr)
-            {
-                // create new buffer
-                state->m_incoming.rawBuffer = new Packet(packet->getData(), packet->getLength());
-            }
-            else
-            {
-                // append to buffer
-                uint pos = state->m_incoming.rawBuffer->getPosition();
-                state->m_incoming.rawBuffer->seek(state->m_incoming.rawBuffer->getLength());
-                state->m_incoming.rawBuffer->writeData(packet->getData(), packet->getLength());
-                state->m_incoming.rawBuffer->seek(pos);
-            }
-
-            delete packet;
+            EXC_SET_BLOCK("next state");
+            continue;
         }
 
         if (g_Serv.IsLoading() == false)
@@ -301,33 +265,49 @@ bool CNetworkInput::processGameClientData(CNetState* state, Packet* buffer)
     CClient* client = state->getClient();
     ASSERT(client != nullptr);
 
+    // decrypt directly after any data left from the previous messages
     EXC_SET_BLOCK("decrypt message");
-    if (!client->m_Crypt.Decrypt(m_decryptBuffer, buffer->getRemainingData(), MAX_BUFFER, buffer->getRemainingLength()))
-    {
-        g_Log.EventError("NET-IN: processGameClientData failed (Decrypt).\n");
-        return false;
-    }
-
     if (state->m_incoming.buffer == nullptr)
     {
-        // create new buffer
-        state->m_incoming.buffer = new Packet(m_decryptBuffer, buffer->getRemainingLength());
-    }
-    else
-    {
-        // append to buffer
-        uint pos = state->m_incoming.buffer->getPosition();
-        state->m_incoming.buffer->seek(state->m_incoming.buffer->getLength());
-        state->m_incoming.buffer->writeData(m_decryptBuffer, buffer->getRemainingLength());
-        state->m_incoming.buffer->seek(pos);
+        state->m_incoming.buffer = new Packet(buffer->getRemainingLength());
+        state->m_incoming.buffer->trim();
     }
 
     Packet* packet = state->m_incoming.buffer;
-    uint remainingLength = packet->getRemainingLength();
+    const uint decryptLength = buffer->getRemainingLength();
+    if (!client->m_Crypt.Decrypt(packet->lockAppend(decryptLength), buffer->getRemainingData(), decryptLength, decryptLength))
+    {
+        g_Log.EventError("NET-IN: processGameClientData failed (Decrypt).\n");
+        return false;
+    }
+    packet->unlockAppend(decryptLength);
 
     EXC_SET_BLOCK("record message");
     xRecordPacket(client, packet, "client->server");
 
+    EXC_SET_BLOCK("process messages");
+    processGameClientPackets(state);
+
+    buffer->seek(buffer->getLength());
+    return true;
+
+    EXC_CATCH;
+    return false;
+}
+
+void CNetworkInput::processGameClientPackets(CNetState* state)
+{
+    ADDTOCALLSTACK("CNetworkInput::processGameClientPackets");
+    EXC_TRY("ProcessGamePackets");
+    ASSERT(state != nullptr);
+    CClient* client = state->getClient();
+    ASSERT(client != nullptr);
+    Packet* packet = state->m_incoming.buffer;
+    ASSERT(packet != nullptr);
+
+    uint remainingLength = packet->getRemainingLength();
+    state->m_incoming.isHeldForWalk = false;
+
     // process the message
     EXC_TRYSUB("ProcessMessage");
 
@@ -357,6 +337,21 @@ bool CNetworkInput::processGameClientData(CNetState* state, Packet* buffer)
                 break;
             }
 
+            // walk requests are queued for the world thread: make sure they are processed before any other
+            // packet the client sent after them (using a door right after stepping next to it...)
+            if ((packetId != XCMD_WalkRequest) && state->hasWalkSteps())
+            {
+                if (m_thread->isActive())
+                {
+                    // we are on the network thread: keep this packet and the following ones for when the
+                    // world thread has processed the steps (see processData)
+                    state->m_incoming.isHeldForWalk = true;
+                    break;
+                }
+                // without network threads we are on the world thread, process them now
+                client->Event_WalkSteps();
+            }
+
             remainingLength -= packetLength;
 
             // Packet filtering - check if any function trigger is installed
@@ -367,15 +362,22 @@ bool CNetworkInput::processGameClientData(CNetState* state, Packet* buffer)
                 continue;
             }
 
-            // copy data to handler
-            handler->seek();
-            handler->writeData(packet->getRemainingData(), packetLength);
+            // let the handler read the data in place, move to position 1 (no need for id) and fire onReceive()
+            handler->setView(packet->getRemainingData(), packetLength);
             packet->skip((int)packetLength);
 
-            // move to position 1 (no need for id) and fire onReceive()
-            handler->resize(packetLength);
             handler->seek(1);
-            handler->onReceive(state);
+            if (PacketStats::isEnabled())
+            {
+                const llong iStartTime = CSTime::GetPreciseSysTimeMicro();
+                handler->onReceive(state);
+                PacketStats::recordReceived(packetId, packetLength, CSTime::GetPreciseSysTimeMicro() - iStartTime);
+            }
+            else
+            {
+                handler->onReceive(state);
+            }
+            state->countIO(0, 1);
         }
         else
         {
@@ -433,11 +435,7 @@ bool CNetworkInput::processGameClientData(CNetState* state, Packet* buffer)
         delete packet;
     }
 
-    buffer->seek(buffer->getLength());
-    return true;
-
     EXC_CATCH;
-    return false;
 }
 
 bool CNetworkInput::processOtherClientData(CNetState* state, Packet* buffer)
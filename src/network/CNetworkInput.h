@@ -17,8 +17,6 @@ class CNetworkInput
 {
 private:
     CNetworkThread* m_thread;	// owning network thread
-    byte* m_receiveBuffer;		// buffer for received data
-    byte* m_decryptBuffer;		// buffer for decrypted data
 
 public:
     static const char* m_sClassName;
@@ -42,6 +40,7 @@ private:
     bool processUnknownClientData(CNetState* state, Packet* buffer);    // process data from an unknown client type
     bool processOtherClientData(CNetState* state, Packet* buffer);      // process data from a non-game client
     bool processGameClientData(CNetState* state, Packet* buffer);       // process data from a game client
+    void processGameClientPackets(CNetState* state);                    // process the decrypted packets of a game client
 };
 
 #endif // _INC_CNETWORKINPUT_H
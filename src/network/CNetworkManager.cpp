@@ -6,6 +6,9 @@
 #include "CNetworkThread.h"
 #include "CNetworkManager.h"
 
+#define NETWORK_BALANCEPERIOD	(10 * MSECS_PER_SEC)	// interval between network thread load checks
+#define NETWORK_BALANCEMINLOAD	(1024 * 1024)			// min bytes processed by a thread during an interval before moving its clients
+
 
 CNetworkManager::CNetworkManager(void)
 {
@@ -13,6 +16,7 @@ CNetworkManager::CNetworkManager(void)
     m_stateCount = 0;
     m_lastGivenSlot = -1;
     m_isThreaded = false;
+    m_lastBalanceTime = 0;
 }
 
 CNetworkManager::~CNetworkManager(void)
@@ -73,12 +77,89 @@ CNetworkThread* CNetworkManager::selectBestThread(void)
     return bestThread;
 }
 
-void CNetworkManager::assignNetworkState(CNetState* state)
+void CNetworkManager::balanceThreads(void)
+{
+    // threads report the amount of data processed for their clients, when a thread
+    // is handling much more than another one we move some of its load over
+    ADDTOCALLSTACK("CNetworkManager::balanceThreads");
+
+    const llong iTimeNow = CSTime::GetPreciseSysTimeMilli();
+    if (m_lastBalanceTime == 0)
+        m_lastBalanceTime = iTimeNow;
+    if ((iTimeNow - m_lastBalanceTime) < NETWORK_BALANCEPERIOD)
+        return;
+    m_lastBalanceTime = iTimeNow;
+
+    for (NetworkThreadList::iterator it = m_threads.begin(), end = m_threads.end(); it != end; ++it)
+    {
+        (*it)->m_loadBytes = 0;
+        (*it)->m_loadPackets = 0;
+    }
+
+    for (int i = 0; i < m_stateCount; ++i)
+    {
+        CNetState* state = m_states[i];
+        state->m_lastLoad = state->m_ioBytes.exchange(0, std::memory_order_relaxed);
+        const ullong uiPackets = state->m_ioPackets.exchange(0, std::memory_order_relaxed);
+
+        CNetworkThread* thread = state->getParentThread();
+        if (thread == nullptr || state->isInUse() == false)
+            continue;
+
+        thread->m_loadBytes += state->m_lastLoad;
+        thread->m_loadPackets += uiPackets;
+    }
+
+    if (isThreaded() == false || m_threads.size() < 2)
+        return;
+
+    CNetworkThread* busiestThread = nullptr;
+    CNetworkThread* quietestThread = nullptr;
+    for (NetworkThreadList::iterator it = m_threads.begin(), end = m_threads.end(); it != end; ++it)
+    {
+        DEBUGNETWORK(("Network thread #%" PRIuSIZE_T " processed %llu bytes, %llu packets for %" PRIuSIZE_T " clients.\n",
+            (*it)->id(), (*it)->getLoadBytes(), (*it)->getLoadPackets(), (*it)->getClientCount()));
+
+        if (busiestThread == nullptr || (*it)->getLoadBytes() > busiestThread->getLoadBytes())
+            busiestThread = *it;
+        if (quietestThread == nullptr || (*it)->getLoadBytes() < quietestThread->getLoadBytes())
+            quietestThread = *it;
+    }
+
+    // only bother when the difference is significant
+    if (busiestThread->getLoadBytes() < NETWORK_BALANCEMINLOAD || busiestThread->getLoadBytes() < (quietestThread->getLoadBytes() * 2))
+        return;
+
+    // pick the busiest client that doesn't simply move the imbalance to the other thread
+    const ullong uiExcess = (busiestThread->getLoadBytes() - quietestThread->getLoadBytes()) / 2;
+    CNetState* bestState = nullptr;
+    for (int i = 0; i < m_stateCount; ++i)
+    {
+        CNetState* state = m_states[i];
+        if (state->getParentThread() != busiestThread || state->isInUse() == false || state->isClosing())
+            continue;
+        if (state->m_lastLoad == 0 || state->m_lastLoad > uiExcess)
+            continue;
+        if (bestState == nullptr || state->m_lastLoad > bestState->m_lastLoad)
+            bestState = state;
+    }
+
+    if (bestState == nullptr)
+        return;
+
+    // the owning thread hands the state over once its output is at a flush boundary
+    DEBUGNETWORK(("%x:Requesting move from network thread #%" PRIuSIZE_T " to #%" PRIuSIZE_T " (%llu bytes).\n",
+        bestState->id(), busiestThread->id(), quietestThread->id(), bestState->m_lastLoad));
+    bestState->m_migrateTo = quietestThread;
+}
+
+void CNetworkManager::assignNetworkState(CNetState* state, CNetworkThread* thread)
 {
     // assign a state to a thread
     ADDTOCALLSTACK("CNetworkManager::assignNetworkState");
 
-    CNetworkThread* thread = selectBestThread();
+    if (thread == nullptr)
+        thread = selectBestThread();
     ASSERT(thread != nullptr);
     thread->assignNetworkState(state);
 }
@@ -123,6 +204,44 @@ void CNetworkManager::acceptNewConnection(void)
     if (h == INVALID_SOCKET)
         return;
 
+    EXC_SET_BLOCK("register");
+    registerNewConnection(h, client_addr, nullptr);
+
+    EXC_CATCH;
+}
+
+void CNetworkManager::queueNewConnection(SOCKET socket, const CSocketAddress& address, CNetworkThread* thread)
+{
+    // called by the network threads, slots and clients can only be set up by the main thread
+    ADDTOCALLSTACK("CNetworkManager::queueNewConnection");
+
+    NewConnection connection;
+    connection.socket = socket;
+    connection.address = address;
+    connection.thread = thread;
+    m_newConnections.push(connection);
+}
+
+void CNetworkManager::processNewConnections(void)
+{
+    // register the connections accepted by the network threads
+    ADDTOCALLSTACK("CNetworkManager::processNewConnections");
+
+    while (m_newConnections.empty() == false)
+    {
+        const NewConnection connection = m_newConnections.front();
+        m_newConnections.pop();
+        registerNewConnection(connection.socket, connection.address, connection.thread);
+    }
+}
+
+void CNetworkManager::registerNewConnection(SOCKET h, const CSocketAddress& client_addr, CNetworkThread* thread)
+{
+    // check and assign a slot to an accepted connection
+    ADDTOCALLSTACK("CNetworkManager::registerNewConnection");
+
+    EXC_TRY("registerNewConnection");
+
     // check ip history
     EXC_SET_BLOCK("ip history");
 
@@ -131,8 +250,8 @@ void CNetworkManager::acceptNewConnection(void)
     int maxIp = g_Cfg.m_iConnectingMaxIP;
     int climaxIp = g_Cfg.m_iClientsMaxIP;
 
-    DEBUGNETWORK(("Incoming connection from '%s' [blocked=%d, ttl=%d, pings=%d, connecting=%d, connected=%d]\n",
-        ip.m_ip.GetAddrStr(), ip.m_blocked, ip.m_ttl, ip.m_pings, ip.m_connecting, ip.m_connected));
+    DEBUGNETWORK(("Incoming connection from '%s' [blocked=%d, pings=%d, connecting=%d, connected=%d]\n",
+        ip.m_ip.GetAddrStr(), ip.m_blocked, ip.m_pings, ip.m_connecting, ip.m_connected));
 
     // check if ip is allowed to connect
     if (ip.checkPing() ||								// check for ip ban
@@ -184,9 +303,10 @@ void CNetworkManager::acceptNewConnection(void)
     if (state->getClient() != nullptr)
         m_clients.InsertContentHead(state->getClient());
 
+    // connections accepted by a network thread stay with it, the load is balanced later on
     EXC_SET_BLOCK("assigning thread");
     DEBUGNETWORK(("%x:Selecting a thread to assign to.\n", state->id()));
-    assignNetworkState(state);
+    assignNetworkState(state, thread);
 
     DEBUGNETWORK(("%x:Client successfully initialised.\n", state->id()));
 
@@ -241,6 +361,9 @@ void CNetworkManager::start(void)
     m_isThreaded = g_Cfg.m_iNetworkThreads > 0;
     if (isThreaded())
     {
+        if (g_Cfg.m_fNetworkReusePort)
+            openListenSockets();
+
         // start network threads
         for (NetworkThreadList::iterator it = m_threads.begin(), end = m_threads.end(); it != end; ++it)
             (*it)->start();		// The thread structure (class) was created via createNetworkThreads, now spawn a new thread and do the work inside there.
@@ -276,11 +399,51 @@ void CNetworkManager::start(void)
     }
 }
 
+void CNetworkManager::openListenSockets(void)
+{
+    // let the kernel spread incoming connections between the network threads: each one listens
+    // on the server port with its own socket, so accepting doesn't wait for the main thread
+    ADDTOCALLSTACK("CNetworkManager::openListenSockets");
+
+#ifdef SO_REUSEPORT
+    size_t count = 0;
+    for (NetworkThreadList::iterator it = m_threads.begin(), end = m_threads.end(); it != end; ++it)
+    {
+        CNetworkThread* thread = *it;
+        if (g_Serv.SocketsInit(thread->m_listenSocket) == false)
+        {
+            g_Log.Event(LOGL_ERROR | LOGM_INIT, "Network thread #%" PRIuSIZE_T " can't listen for connections, they will be accepted by the main thread only.\n", thread->id());
+            thread->m_listenSocket.Close();
+            continue;
+        }
+
+        // the thread must tick in order to check its socket, even without clients
+        thread->setPriority(IThread::Low);
+        ++count;
+    }
+
+    g_Log.Event(LOGM_INIT, "Accepting connections on %" PRIuSIZE_T " network threads.\n", count);
+#else
+    g_Log.Event(LOGL_WARN | LOGM_INIT, "NetworkReusePort is not supported on this system.\n");
+#endif
+}
+
 void CNetworkManager::stop(void)
 {
     // terminate child threads
     for (NetworkThreadList::iterator it = m_threads.begin(), end = m_threads.end(); it != end; ++it)
+    {
         (*it)->waitForClose();
+        (*it)->m_listenSocket.Close();
+    }
+
+    // drop the connections that never got a slot
+    while (m_newConnections.empty() == false)
+    {
+        const NewConnection connection = m_newConnections.front();
+        m_newConnections.pop();
+        CLOSESOCKET(connection.socket);
+    }
 }
 
 void CNetworkManager::tick(void)
@@ -294,12 +457,6 @@ void CNetworkManager::tick(void)
         if (state->isInUse() == false)
             continue;
 
-        // clean packet queue entries
-        EXC_SET_BLOCK("cleaning queues");
-        for (int priority = 0; priority < PacketSend::PRI_QTY; ++priority)
-            state->m_outgoing.queue[priority].clean();
-        state->m_outgoing.asyncQueue.clean();
-
         EXC_SET_BLOCK("check closing");
         if (state->isClosing() == false)
         {
@@ -349,6 +506,10 @@ void CNetworkManager::tick(void)
     // tick ip history
     m_ips.tick();
 
+    // spread the load over the network threads
+    EXC_SET_BLOCK("balance threads");
+    balanceThreads();
+
     // tick child threads, if single-threaded mode (otherwise they will tick themselves)
     if (isThreaded() == false)
     {
@@ -373,12 +534,39 @@ void CNetworkManager::processAllInput(void)
     if (checkNewConnection())
         acceptNewConnection();
 
+    // connections accepted by the network threads
+    processNewConnections();
+
     if (isInputThreaded() == false)	// Don't do this if the input is multi threaded, since the CNetworkThread ticks automatically by itself
     {
         // force each thread to process input (NOT THREADSAFE)
         for (NetworkThreadList::iterator it = m_threads.begin(), end = m_threads.end(); it != end; ++it)
             (*it)->processInput();
     }
+
+    // walk requests are queued by the input processing, whichever thread it runs on
+    processWalkRequests();
+}
+
+void CNetworkManager::processWalkRequests(void)
+{
+    ADDTOCALLSTACK("CNetworkManager::processWalkRequests");
+
+    EXC_TRY("ProcessWalkRequests");
+    for (int i = 0; i < m_stateCount; ++i)
+    {
+        CNetState* state = m_states[i];
+        if (state->isInUse() == false || state->isClosing() || state->hasWalkSteps() == false)
+            continue;
+
+        CClient* client = state->getClient();
+        if (client == nullptr)
+            continue;
+
+        EXC_SET_BLOCK("walk");
+        client->Event_WalkSteps();
+    }
+    EXC_CATCH;
 }
 
 void CNetworkManager::processAllOutput(void)
@@ -7,6 +7,7 @@
 #define _INC_CNETWORKMANAGER_H
 
 #include "../common/sphere_library/CSObjList.h"
+#include "../sphere/containers.h"
 #include "CIPHistoryManager.h"
 #include "CPacketManager.h"
 
@@ -21,6 +22,7 @@ private:
     int  m_stateCount;				// client state count
     int  m_lastGivenSlot;			// last slot index assigned
     bool m_isThreaded;
+    llong m_lastBalanceTime;		// last time the load of the network threads was checked
 
     typedef std::deque<CNetworkThread*> NetworkThreadList;
     NetworkThreadList m_threads;	// list of network threads
@@ -28,6 +30,14 @@ private:
     CSObjList m_clients;			// current list of clients (CClient)
     PacketManager m_packets;		// packet handlers
 
+    struct NewConnection
+    {
+        SOCKET socket;
+        CSocketAddress address;
+        CNetworkThread* thread;		// network thread that accepted the connection
+    };
+    ThreadSafeQueue<NewConnection> m_newConnections;	// connections accepted by network threads, waiting for a slot
+
 public:
     static const char* m_sClassName;
     CNetworkManager(void);
@@ -44,9 +54,11 @@ public:
 
     bool checkNewConnection(void);				// check if a new connection is waiting to be accepted
     void acceptNewConnection(void);				// accept a new connection
+    void queueNewConnection(SOCKET socket, const CSocketAddress& address, CNetworkThread* thread);	// register a connection accepted by a network thread (THREADSAFE)
 
     void processAllInput(void);					// process network input (NOT THREADSAFE)
     void processAllOutput(void);				// process network output (NOT THREADSAFE)
+    void processWalkRequests(void);				// process the walk requests queued by the clients (NOT THREADSAFE)
     size_t flush(CNetState* state);				// process all output for a client
     void flushAllClients(void);					// force each thread to flush output
 
@@ -54,6 +66,8 @@ public:
     inline const PacketManager& getPacketManager(void) const { return m_packets; }		// get packet manager
     inline IPHistoryManager& getIPHistoryManager(void) { return m_ips; }	// get ip history manager
     inline bool isThreaded(void) const { return m_isThreaded; } // are threads active
+    inline size_t getThreadCount(void) const { return m_threads.size(); }	// get number of network threads
+    inline const CNetworkThread* getThread(size_t index) const { return m_threads[index]; }	// get network thread at index
     inline bool isInputThreaded(void) const // is network input handled by thread
     {
         return m_isThreaded;
@@ -67,7 +81,11 @@ public:
 private:
     void createNetworkThreads(size_t count);	// create n threads to handle client i/o
     CNetworkThread* selectBestThread(void);		// select the most suitable thread for handling a new client
-    void assignNetworkState(CNetState* state);	// assign a state to a thread
+    void balanceThreads(void);					// move clients from the busiest network thread to the quietest one
+    void registerNewConnection(SOCKET socket, const CSocketAddress& address, CNetworkThread* thread);	// check and assign a slot to an accepted connection
+    void processNewConnections(void);			// register the connections accepted by network threads
+    void openListenSockets(void);				// give each network thread its own listening socket
+    void assignNetworkState(CNetState* state, CNetworkThread* thread = nullptr);	// assign a state to a thread
     CNetState* findFreeSlot(int start = -1);	// find an unused slot for new client
 
     friend class ClientIterator;
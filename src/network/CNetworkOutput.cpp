@@ -5,6 +5,10 @@
 #include "CNetState.h"
 #include "CNetworkThread.h"
 #include "CNetworkOutput.h"
+#include "CPacketStats.h"
+
+
+std::atomic<ullong> CNetworkOutput::sm_coalescedCount[UCHAR_MAX + 1];
 
 
 #ifdef _WIN32
@@ -103,6 +107,11 @@ bool CNetworkOutput::processOutput()
 		if (state->isWriteClosed())
 			continue;
 
+		// a congested client only receives the most important packets, everything else is held back (and
+		// superseded updates are collapsed) until it has caught up
+		state->sampleBandwidth();
+		const bool isCongested = state->isCongested();
+
 		// process packet queues
 		for (int priority = PacketSend::PRI_HIGHEST; priority >= 0; --priority)
 		{
@@ -110,7 +119,11 @@ bool CNetworkOutput::processOutput()
 				continue;
 			else if (state->isWriteClosed())
 				break;
-			packetsSent += processPacketQueue(state, priority);
+
+			if (isCongested && priority < PacketSend::PRI_HIGH)
+				holdPacketQueue(state, priority);
+			else
+				packetsSent += processPacketQueue(state, priority);
 		}
 
 		// process asynchronous queue
@@ -205,7 +218,7 @@ size_t CNetworkOutput::processPacketQueue(CNetState* state, uint priority)
 	ASSERT(!m_thread->isActive() || m_thread->isCurrentThread());
 
 	if (state->isWriteClosed() ||
-		(state->m_outgoing.queue[priority].empty() && state->m_outgoing.currentTransaction == nullptr))
+		(state->m_outgoing.queue[priority].empty() && state->m_outgoing.held[priority].empty() && state->m_outgoing.currentTransaction == nullptr))
 		return 0;
 
 	CClient* client = state->getClient();
@@ -218,9 +231,17 @@ size_t CNetworkOutput::processPacketQueue(CNetState* state, uint priority)
 
 	while (packetsProcessed < maxPacketsToProcess && lengthProcessed < maxLengthToProcess)
 	{
-		// select next transaction
+		// select next transaction (held transactions are older than the queued ones)
 		while (state->m_outgoing.currentTransaction == nullptr)
 		{
+			if (state->m_outgoing.held[priority].empty() == false)
+			{
+				state->m_outgoing.currentTransaction = state->m_outgoing.held[priority].front();
+				state->m_outgoing.held[priority].pop_front();
+				--state->m_outgoing.heldCount;
+				continue;
+			}
+
 			if (state->m_outgoing.queue[priority].empty())
 				break;
 
@@ -235,6 +256,7 @@ size_t CNetworkOutput::processPacketQueue(CNetState* state, uint priority)
 		// acquire next packet from transaction
 		PacketSend* packet = transaction->front();
 		transaction->pop();
+		state->m_outgoing.queuedBytes -= packet->getLength();
 
 		// if the transaction is now empty we can clear it now so we can move
 		// on to the next transaction later
@@ -251,9 +273,18 @@ size_t CNetworkOutput::processPacketQueue(CNetState* state, uint priority)
 			continue;
 		}
 
+		// skip updates superseded by a newer one for the same object
+		if (state->isSuperseded(packet->getData()[0], packet->m_coalesceUID, packet->m_coalesceGeneration))
+		{
+			sm_coalescedCount[packet->getData()[0]].fetch_add(1, std::memory_order_relaxed);
+			delete packet;
+			continue;
+		}
+
 		EXC_TRY("processPacketQueue");
 		lengthProcessed += packet->getLength();
 		++packetsProcessed;
+		state->countIO(0, 1);
 
 		EXC_SET_BLOCK("sending");
 		if (sendPacket(state, packet) == false)
@@ -282,6 +313,49 @@ size_t CNetworkOutput::processPacketQueue(CNetState* state, uint priority)
 	return packetsProcessed;
 }
 
+void CNetworkOutput::holdPacketQueue(CNetState* state, uint priority)
+{
+	// move a client's packet queue aside whilst it is congested, dropping the superseded updates
+	ADDTOCALLSTACK("CNetworkOutput::holdPacketQueue");
+	ASSERT(state != nullptr);
+	ASSERT(!m_thread->isActive() || m_thread->isCurrentThread());
+
+	while (state->m_outgoing.queue[priority].empty() == false)
+	{
+		PacketTransaction* transaction = state->m_outgoing.queue[priority].front();
+		state->m_outgoing.queue[priority].pop();
+
+		// only single packet transactions can be superseded
+		PacketSend* packet = transaction->empty() ? nullptr : transaction->front();
+		if (packet != nullptr && state->isSuperseded(packet->getData()[0], packet->m_coalesceUID, packet->m_coalesceGeneration))
+		{
+			sm_coalescedCount[packet->getData()[0]].fetch_add(1, std::memory_order_relaxed);
+			state->m_outgoing.queuedBytes -= packet->getLength();
+			transaction->pop();
+			delete packet;
+			if (transaction->empty())
+			{
+				delete transaction;
+				continue;
+			}
+		}
+
+		state->m_outgoing.held[priority].push_back(transaction);
+		++state->m_outgoing.heldCount;
+	}
+
+	// the held transactions are limited like the queues. They can't be dropped (the client would be out of sync
+	// for good, only the superseded updates are), so a client still so far behind is disconnected
+	const size_t maxQueueSize = (size_t)maximum(0, NETWORK_MAXQUEUESIZE);
+	if (maxQueueSize == 0 || state->m_outgoing.heldCount <= maxQueueSize)
+		return;
+
+	g_Log.Event(LOGM_CLIENTS_LOG|LOGL_WARN, "%x:Client disconnected, it can't keep up with the data sent to it (%" PRIuSIZE_T " transactions held back, NetMaxQueueSize=%d).\n",
+		state->id(), state->m_outgoing.heldCount.load(), NETWORK_MAXQUEUESIZE);
+	state->clearQueues();
+	state->markWriteClosed();
+}
+
 size_t CNetworkOutput::processAsyncQueue(CNetState* state)
 {
 	// process a client's async queue
@@ -443,6 +517,9 @@ bool CNetworkOutput::sendPacketData(CNetState* state, PacketSend* packet)
 		sendBufferLength = packet->getLength();
 	}
 
+	if (PacketStats::isEnabled())
+		PacketStats::recordSent(packet->getData()[0], packet->getLength(), sendBufferLength);
+
 	// queue packet data
 	EXC_SET_BLOCK("queue data");
 	state->m_outgoing.bytes.AddNewData(sendBuffer, sendBufferLength);
@@ -557,7 +634,11 @@ size_t CNetworkOutput::sendData(CNetState* state, const byte* data, size_t lengt
 	}
 
 	if (result > 0 && result != _failed_result())
+	{
+		state->m_outgoing.sentBytes += result;
+		state->countIO(result, 0);
 		CurrentProfileData.Count(PROFILE_DATA_TX, (dword)(result));
+	}
 
 	return result;
 	EXC_CATCH;
@@ -605,10 +686,27 @@ void CNetworkOutput::QueuePacket(PacketSend* packet, bool appendTransaction)
 		return;
 	}
 
+	if (packet->m_buildStartTime != 0)
+		PacketStats::recordBuild(packet->getData()[0], CSTime::GetPreciseSysTimeMicro() - packet->m_buildStartTime);
+
+	state->m_outgoing.queuedBytes += packet->getLength();
 	if (state->m_outgoing.pendingTransaction != nullptr && appendTransaction)
+	{
 		state->m_outgoing.pendingTransaction->emplace_back(packet);
-	else
-		QueuePacketTransaction(new SimplePacketTransaction(packet));
+		return;
+	}
+
+	// a packet describing the whole state of an object makes obsolete the ones for the same object still waiting in queue
+	// (packets grouped in a transaction are never coalesced, their order is meaningful)
+	if (packet->m_coalesceUID != 0)
+		packet->m_coalesceGeneration = state->markSupersedable(packet->getData()[0], packet->m_coalesceUID);
+
+	QueuePacketTransaction(new SimplePacketTransaction(packet));
+}
+
+ullong CNetworkOutput::getCoalescedCount(byte packetId)
+{
+	return sm_coalescedCount[packetId].load(std::memory_order_relaxed);
 }
 
 void CNetworkOutput::QueuePacketTransaction(PacketTransaction* transaction)
@@ -621,6 +719,17 @@ void CNetworkOutput::QueuePacketTransaction(PacketTransaction* transaction)
 	CNetState* state = transaction->getTarget();
 	if (state == nullptr || state->isInUse() == false || state->isWriteClosed())
 	{
+		if (state != nullptr)
+		{
+			// the packets were counted as queued by QueuePacket
+			while (transaction->empty() == false)
+			{
+				PacketSend* packet = transaction->front();
+				transaction->pop();
+				state->m_outgoing.queuedBytes -= packet->getLength();
+				delete packet;
+			}
+		}
 		delete transaction;
 		return;
 	}
@@ -7,6 +7,7 @@
 #define _INC_NETWORKOUTPUT_H
 
 #include "../common/common.h"
+#include <atomic>
 
 class CNetworkThread;
 class PacketTransaction;
@@ -20,6 +21,8 @@ class CNetworkOutput
 private:
 	static constexpr inline size_t _failed_result(void) { return INTPTR_MAX; }
 
+	static std::atomic<ullong> sm_coalescedCount[UCHAR_MAX + 1];	// packets dropped because superseded, per packet id
+
 private:
 	CNetworkThread* m_thread;	// owning network thread
 	byte* m_encryptBuffer;		// buffer for encrpyted data
@@ -41,10 +44,12 @@ public:
 
 	static void QueuePacket(PacketSend* packet, bool appendTransaction);// queue a packet for sending
 	static void QueuePacketTransaction(PacketTransaction* transaction);	// queue a packet transaction for sending
+	static ullong getCoalescedCount(byte packetId);						// number of packets dropped because superseded by a newer one
 
 private:
 	void checkFlushRequests(void);										// check for clients who need data flushing
 	size_t processPacketQueue(CNetState* state, uint priority);	// process a client's packet queue
+	void holdPacketQueue(CNetState* state, uint priority);				// hold back a congested client's packet queue
 	size_t processAsyncQueue(CNetState* state);							// process a client's async queue
 	bool processByteQueue(CNetState* state);								// process a client's byte queue
 
@@ -5,6 +5,8 @@
 #include "CNetworkOutput.h"
 #include "CNetworkThread.h"
 
+#define NETWORK_ACCEPTMAX	32	// max connections accepted by a thread per tick
+
 
 static const char* GenerateNetworkThreadName(size_t id)
 {
@@ -16,7 +18,7 @@ static const char* GenerateNetworkThreadName(size_t id)
 
 CNetworkThread::CNetworkThread(CNetworkManager* manager, size_t id)
     : AbstractSphereThread(GenerateNetworkThreadName(id), IThread::Disabled),
-    m_manager(manager), m_id(id)
+    m_manager(manager), m_id(id), m_loadBytes(0), m_loadPackets(0)
 {
 }
 
@@ -46,6 +48,26 @@ void CNetworkThread::queuePacketTransaction(PacketTransaction* transaction)
     CNetworkOutput::QueuePacketTransaction(transaction);
 }
 
+void CNetworkThread::acceptConnections(void)
+{
+    // accept connections waiting on our listening socket, the main thread will
+    // give them a slot and assign them back to us
+    ADDTOCALLSTACK("CNetworkThread::acceptConnections");
+    if (m_listenSocket.IsOpen() == false)
+        return;
+
+    for (int i = 0; i < NETWORK_ACCEPTMAX; ++i)
+    {
+        CSocketAddress client_addr;
+        SOCKET h = m_listenSocket.Accept(client_addr);
+        if (h == INVALID_SOCKET)
+            break;
+
+        DEBUGNETWORK(("Network thread #%" PRIuSIZE_T " accepted connection from '%s'.\n", id(), client_addr.GetAddrStr()));
+        m_manager->queueNewConnection(h, client_addr, this);
+    }
+}
+
 void CNetworkThread::checkNewStates(void)
 {
     // check for states that have been assigned but not moved to our list
@@ -83,6 +105,21 @@ void CNetworkThread::dropInvalidStates(void)
             state->setParentThread(nullptr);
             it = m_states.erase(it);
         }
+        else if (state->m_migrateTo.load() != nullptr && state->canMigrate())
+        {
+            // state is being moved to a less busy thread, which will take it from its assign queue
+            CNetworkThread* thread = state->m_migrateTo.exchange(nullptr);
+            if (thread == nullptr || thread == this)
+            {
+                ++it;
+                continue;
+            }
+
+            DEBUGNETWORK(("%x:Moving client from network thread #%" PRIuSIZE_T " to #%" PRIuSIZE_T ".\n", state->id(), id(), thread->id()));
+            it = m_states.erase(it);
+            state->setParentThread(thread);
+            thread->assignNetworkState(state);
+        }
         else
         {
             // state is good
@@ -106,13 +143,14 @@ void CNetworkThread::tick(void)
 {
     // process periodic actions
     ADDTOCALLSTACK("CNetworkThread::tick");
+    acceptConnections();
     checkNewStates();
     dropInvalidStates();
 
     if (m_states.empty())
     {
-        // we haven't been assigned any clients, so go idle for now
-        if (getPriority() != IThread::Disabled)
+        // we haven't been assigned any clients, so go idle for now (keep ticking if we are listening)
+        if (getPriority() != IThread::Disabled || m_listenSocket.IsOpen())
             setPriority(IThread::Low);
         return;
     }
@@ -121,7 +159,10 @@ void CNetworkThread::tick(void)
     processOutput();
 
     // we're active, take priority
-    setPriority(static_cast<IThread::Priority>(g_Cfg.m_iNetworkThreadPriority));
+    IThread::Priority priority = static_cast<IThread::Priority>(g_Cfg.m_iNetworkThreadPriority);
+    if (priority == IThread::Disabled && m_listenSocket.IsOpen())
+        priority = IThread::Low;
+    setPriority(priority);
 }
 
 void CNetworkThread::flushAllClients(void)
@@ -10,6 +10,7 @@
 #include "../sphere/containers.h"
 #include "CNetworkInput.h"
 #include "CNetworkOutput.h"
+#include "CSocket.h"
 
 class CNetState;
 class CNetworkManager;
@@ -26,6 +27,10 @@ private:
     NetworkStateList m_states;					// states controlled by this thread
 
     ThreadSafeQueue<CNetState*> m_assignQueue;	// queue of states waiting to be taken by this thread
+    CSocket m_listenSocket;						// socket sharing the server port with the main one (SO_REUSEPORT), if any
+
+    ullong m_loadBytes;		// bytes received and sent by the clients of this thread during the last load check interval
+    ullong m_loadPackets;	// packets received and sent by the clients of this thread during the last load check interval
 
     CNetworkInput m_input;		// handles data input
     CNetworkOutput m_output;		// handles data output
@@ -33,6 +38,8 @@ private:
 public:
     size_t id(void) const { return m_id; }							// network thread #
     size_t getClientCount(void) const { return m_states.size(); }	// current number of clients controlled by thread
+    ullong getLoadBytes(void) const { return m_loadBytes; }			// bytes processed during the last load check interval
+    ullong getLoadPackets(void) const { return m_loadPackets; }		// packets processed during the last load check interval
 
 public:
     static const char* m_sClassName;
@@ -80,8 +87,9 @@ public:
     void flushAllClients(void);			// flush all output
 
 private:
+    void acceptConnections(void);		// accept connections waiting on our listening socket
     void checkNewStates(void);			// check for states that have been assigned but not moved to our list
-    void dropInvalidStates(void);		// check for states that don't belong to use anymore
+    void dropInvalidStates(void);		// check for states that don't belong to use anymore, or have to be moved to another thread
 
 public:
     friend class CNetworkManager;
@@ -0,0 +1,229 @@
+#include "../common/sphere_library/smutex.h"
+#include "CPacketPool.h"
+#include <atomic>
+#include <new>
+
+#define PACKETPOOL_CACHEBYTES	(256 * 1024)		// max bytes kept by a thread cache, per size class
+#define PACKETPOOL_DEPOTBYTES	(4 * 1024 * 1024)	// max bytes kept by the shared depot, per size class
+#define PACKETPOOL_MINCACHE		4					// min blocks kept by a thread cache, per size class
+
+
+namespace
+{
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	struct PoolDepot
+	{
+		SimpleMutex mutex;
+		FreeBlock* head;
+		size_t count;
+
+		PoolDepot() : head(nullptr), count(0) { }
+	};
+
+	struct PoolClassStats
+	{
+		std::atomic<ullong> hits;
+		std::atomic<ullong> misses;
+
+		PoolClassStats() : hits(0), misses(0) { }
+	};
+
+	// function-local statics, packets may be created before or after global objects of other units
+	PoolDepot* GetDepots()
+	{
+		static PoolDepot s_depots[PACKETPOOL_CLASSES];
+		return s_depots;
+	}
+
+	PoolClassStats* GetStats()
+	{
+		static PoolClassStats s_stats[PACKETPOOL_CLASSES];
+		return s_stats;
+	}
+
+	inline uint GetClassIndex(size_t size) noexcept
+	{
+		uint index = 0;
+		for (size_t classSize = PACKETPOOL_MINSIZE; classSize < size; classSize <<= 1)
+			++index;
+		return index;
+	}
+
+	inline size_t GetClassLimit(uint index, size_t maxBytes) noexcept
+	{
+		const size_t limit = maxBytes / (PACKETPOOL_MINSIZE << index);
+		return (limit > PACKETPOOL_MINCACHE) ? limit : PACKETPOOL_MINCACHE;
+	}
+
+	class PoolThreadCache
+	{
+	private:
+		FreeBlock* m_head[PACKETPOOL_CLASSES];
+		size_t m_count[PACKETPOOL_CLASSES];
+
+	public:
+		PoolThreadCache()
+		{
+			for (uint i = 0; i < PACKETPOOL_CLASSES; ++i)
+			{
+				m_head[i] = nullptr;
+				m_count[i] = 0;
+			}
+		}
+
+		~PoolThreadCache()
+		{
+			// thread is exiting, let the other threads reuse our blocks
+			for (uint i = 0; i < PACKETPOOL_CLASSES; ++i)
+				spill(i, m_count[i]);
+		}
+
+	private:
+		PoolThreadCache(const PoolThreadCache& copy);
+		PoolThreadCache& operator=(const PoolThreadCache& other);
+
+	public:
+		FreeBlock* pop(uint index)
+		{
+			if (m_head[index] == nullptr)
+				refill(index);
+
+			FreeBlock* block = m_head[index];
+			if (block != nullptr)
+			{
+				m_head[index] = block->next;
+				--m_count[index];
+			}
+			return block;
+		}
+
+		void push(uint index, void* data)
+		{
+			FreeBlock* block = static_cast<FreeBlock*>(data);
+			block->next = m_head[index];
+			m_head[index] = block;
+			++m_count[index];
+
+			const size_t limit = GetClassLimit(index, PACKETPOOL_CACHEBYTES);
+			if (m_count[index] > limit)
+				spill(index, limit / 2);
+		}
+
+	private:
+		void refill(uint index)
+		{
+			// take a batch of blocks from the depot
+			PoolDepot& depot = GetDepots()[index];
+			const size_t batch = GetClassLimit(index, PACKETPOOL_CACHEBYTES) / 2;
+
+			SimpleThreadLock lock(depot.mutex);
+			while (depot.head != nullptr && m_count[index] < batch)
+			{
+				FreeBlock* block = depot.head;
+				depot.head = block->next;
+				--depot.count;
+
+				block->next = m_head[index];
+				m_head[index] = block;
+				++m_count[index];
+			}
+		}
+
+		void spill(uint index, size_t amount)
+		{
+			// move a batch of blocks to the depot, or back to the system if the depot is full
+			PoolDepot& depot = GetDepots()[index];
+			const size_t depotLimit = GetClassLimit(index, PACKETPOOL_DEPOTBYTES);
+
+			SimpleThreadLock lock(depot.mutex);
+			for (; amount > 0 && m_head[index] != nullptr; --amount)
+			{
+				FreeBlock* block = m_head[index];
+				m_head[index] = block->next;
+				--m_count[index];
+
+				if (depot.count >= depotLimit)
+				{
+					::operator delete(block);
+					continue;
+				}
+
+				block->next = depot.head;
+				depot.head = block;
+				++depot.count;
+			}
+		}
+	};
+
+	PoolThreadCache& GetThreadCache()
+	{
+		static thread_local PoolThreadCache s_cache;
+		return s_cache;
+	}
+}
+
+
+/***************************************************************************
+ *
+ *
+ *	class PacketPool			Recycles memory used by packets
+ *
+ *
+ ***************************************************************************/
+void* PacketPool::allocate(size_t size, size_t* capacity)
+{
+	const uint index = GetClassIndex(size);
+	if (index >= PACKETPOOL_CLASSES)
+	{
+		// too big to be worth pooling
+		if (capacity != nullptr)
+			*capacity = size;
+		return ::operator new(size);
+	}
+
+	const size_t classSize = (size_t)PACKETPOOL_MINSIZE << index;
+	if (capacity != nullptr)
+		*capacity = classSize;
+
+	void* block = GetThreadCache().pop(index);
+	if (block != nullptr)
+	{
+		GetStats()[index].hits.fetch_add(1, std::memory_order_relaxed);
+		return block;
+	}
+
+	GetStats()[index].misses.fetch_add(1, std::memory_order_relaxed);
+	return ::operator new(classSize);
+}
+
+void PacketPool::release(void* block, size_t size)
+{
+	if (block == nullptr)
+		return;
+
+	const uint index = GetClassIndex(size);
+	if (index >= PACKETPOOL_CLASSES)
+	{
+		::operator delete(block);
+		return;
+	}
+
+	GetThreadCache().push(index, block);
+}
+
+size_t PacketPool::getClassSize(uint index)
+{
+	ASSERT(index < PACKETPOOL_CLASSES);
+	return (size_t)PACKETPOOL_MINSIZE << index;
+}
+
+void PacketPool::getClassStats(uint index, ullong& hits, ullong& misses)
+{
+	ASSERT(index < PACKETPOOL_CLASSES);
+	hits = GetStats()[index].hits.load(std::memory_order_relaxed);
+	misses = GetStats()[index].misses.load(std::memory_order_relaxed);
+}
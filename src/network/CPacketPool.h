@@ -0,0 +1,45 @@
+/**
+* @file CPacketPool.h
+* @brief Size-classed memory pool for packet objects and packet data buffers.
+*/
+
+#ifndef _INC_CPACKETPOOL_H
+#define _INC_CPACKETPOOL_H
+
+#include "../common/common.h"
+
+
+#define PACKETPOOL_MINSIZE		128			// smallest block handed out by the pool
+#define PACKETPOOL_CLASSES		10			// number of size classes (128 bytes up to 64 KB, doubling)
+
+
+/***************************************************************************
+ *
+ *
+ *	class PacketPool			Recycles memory used by packets
+ *
+ *	Every thread owns a private cache of free blocks for each size class, so
+ *	in the steady state allocating and releasing a packet (or its buffer) is
+ *	a free-list pop/push without locks. Packets are usually built on the main
+ *	thread and destroyed by a network thread: blocks exceeding a thread cache
+ *	limit are moved in batches to a shared depot, where the other threads
+ *	can pick them up again.
+ *
+ ***************************************************************************/
+class PacketPool
+{
+public:
+	static void* allocate(size_t size, size_t* capacity = nullptr);	// get a block of at least size bytes (capacity receives the real block size)
+	static void release(void* block, size_t size);					// give back a block, size must be the one requested to allocate
+
+	static size_t getClassSize(uint index);							// size of blocks in the given class
+	static void getClassStats(uint index, ullong& hits, ullong& misses);	// number of allocations served from/not from the pool
+
+private:
+	PacketPool(void);
+	PacketPool(const PacketPool& copy);
+	PacketPool& operator=(const PacketPool& other);
+};
+
+
+#endif // _INC_CPACKETPOOL_H
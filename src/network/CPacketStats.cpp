@@ -0,0 +1,82 @@
+#include "../game/CServerConfig.h"
+#include "CPacketStats.h"
+
+
+PacketStats::Counters PacketStats::sm_counters[NETSTATS_DIR_QTY][UCHAR_MAX + 1];
+
+
+/***************************************************************************
+ *
+ *
+ *	class PacketStats			Counts packets, bytes and time by packet id
+ *
+ *
+ ***************************************************************************/
+bool PacketStats::isEnabled(void)
+{
+	return g_Cfg.m_fNetworkStats;
+}
+
+void PacketStats::recordBuild(byte packetId, llong time)
+{
+	if (time > 0)
+		sm_counters[NETSTATS_TX][packetId].time.fetch_add((ullong)time, std::memory_order_relaxed);
+}
+
+void PacketStats::recordSent(byte packetId, size_t bytes, size_t compressed)
+{
+	Counters& counters = sm_counters[NETSTATS_TX][packetId];
+	counters.count.fetch_add(1, std::memory_order_relaxed);
+	counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+	counters.compressed.fetch_add(compressed, std::memory_order_relaxed);
+}
+
+void PacketStats::recordReceived(byte packetId, size_t bytes, llong time)
+{
+	// incoming data is never compressed
+	Counters& counters = sm_counters[NETSTATS_RX][packetId];
+	counters.count.fetch_add(1, std::memory_order_relaxed);
+	counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+	counters.compressed.fetch_add(bytes, std::memory_order_relaxed);
+	if (time > 0)
+		counters.time.fetch_add((ullong)time, std::memory_order_relaxed);
+}
+
+void PacketStats::getEntry(NETSTATS_DIR dir, byte packetId, PacketStatsEntry& entry)
+{
+	ASSERT(dir >= 0 && dir < NETSTATS_DIR_QTY);
+	const Counters& counters = sm_counters[dir][packetId];
+	entry.count = counters.count.load(std::memory_order_relaxed);
+	entry.bytes = counters.bytes.load(std::memory_order_relaxed);
+	entry.compressed = counters.compressed.load(std::memory_order_relaxed);
+	entry.time = counters.time.load(std::memory_order_relaxed);
+}
+
+void PacketStats::getTotal(NETSTATS_DIR dir, PacketStatsEntry& entry)
+{
+	entry.count = entry.bytes = entry.compressed = entry.time = 0;
+	for (uint i = 0; i <= UCHAR_MAX; ++i)
+	{
+		PacketStatsEntry packetEntry;
+		getEntry(dir, (byte)i, packetEntry);
+		entry.count += packetEntry.count;
+		entry.bytes += packetEntry.bytes;
+		entry.compressed += packetEntry.compressed;
+		entry.time += packetEntry.time;
+	}
+}
+
+void PacketStats::reset(void)
+{
+	for (uint dir = 0; dir < NETSTATS_DIR_QTY; ++dir)
+	{
+		for (uint i = 0; i <= UCHAR_MAX; ++i)
+		{
+			Counters& counters = sm_counters[dir][i];
+			counters.count.store(0, std::memory_order_relaxed);
+			counters.bytes.store(0, std::memory_order_relaxed);
+			counters.compressed.store(0, std::memory_order_relaxed);
+			counters.time.store(0, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+/**
+* @file CPacketStats.h
+* @brief Per packet type network accounting.
+*/
+
+#ifndef _INC_CPACKETSTATS_H
+#define _INC_CPACKETSTATS_H
+
+#include "../common/common.h"
+#include <atomic>
+
+
+enum NETSTATS_DIR
+{
+	NETSTATS_TX,	// server -> client
+	NETSTATS_RX,	// client -> server
+	NETSTATS_DIR_QTY
+};
+
+struct PacketStatsEntry
+{
+	ullong count;		// number of packets
+	ullong bytes;		// raw packet bytes
+	ullong compressed;	// bytes on the wire (after huffman compression for game clients)
+	ullong time;		// microseconds spent building (tx) or handling (rx) the packets
+};
+
+
+/***************************************************************************
+ *
+ *
+ *	class PacketStats			Counts packets, bytes and time by packet id
+ *
+ *	Counters are updated by the main and network threads without locking.
+ *	When disabled (NetworkStats=0) the only cost is checking the setting.
+ *
+ ***************************************************************************/
+class PacketStats
+{
+private:
+	struct Counters
+	{
+		std::atomic<ullong> count;
+		std::atomic<ullong> bytes;
+		std::atomic<ullong> compressed;
+		std::atomic<ullong> time;
+	};
+	static Counters sm_counters[NETSTATS_DIR_QTY][UCHAR_MAX + 1];
+
+public:
+	static bool isEnabled(void);
+
+	static void recordBuild(byte packetId, llong time);										// tx packet built in the given time
+	static void recordSent(byte packetId, size_t bytes, size_t compressed);					// tx packet sent
+	static void recordReceived(byte packetId, size_t bytes, llong time);					// rx packet handled in the given time
+
+	static void getEntry(NETSTATS_DIR dir, byte packetId, PacketStatsEntry& entry);
+	static void getTotal(NETSTATS_DIR dir, PacketStatsEntry& entry);
+	static void reset(void);
+
+private:
+	PacketStats(void);
+	PacketStats(const PacketStats& copy);
+	PacketStats& operator=(const PacketStats& other);
+};
+
+
+#endif // _INC_CPACKETSTATS_H
@@ -3,6 +3,8 @@
 #include "../game/clients/CClient.h"
 #include "CNetState.h"
 #include "CNetworkThread.h"
+#include "CPacketPool.h"
+#include "CPacketStats.h"
 #include "net_datatypes.h"
 #include "packet.h"
 
@@ -84,20 +86,20 @@ void xRecordPacket(const CClient* client, Packet* packet, lpctstr heading)
 
 
 
-Packet::Packet(uint size) : m_buffer(nullptr)
+Packet::Packet(uint size) : m_buffer(nullptr), m_bufferCapacity(0)
 {
 	m_expectedLength = size;
 	clear();
 	resize(size > 0 ? size : PACKET_BUFFERDEFAULT);
 }
 
-Packet::Packet(const Packet& other) : m_buffer(nullptr)
+Packet::Packet(const Packet& other) : m_buffer(nullptr), m_bufferCapacity(0)
 {
 	clear();
 	copy(other);
 }
 
-Packet::Packet(const byte* data, uint size) : m_buffer(nullptr)
+Packet::Packet(const byte* data, uint size) : m_buffer(nullptr), m_bufferCapacity(0)
 {
 	clear();
 	m_expectedLength = 0;
@@ -111,6 +113,16 @@ Packet::~Packet(void)
 	clear();
 }
 
+void* Packet::operator new(size_t size)
+{
+	return PacketPool::allocate(size);
+}
+
+void Packet::operator delete(void* ptr, size_t size)
+{
+	PacketPool::release(ptr, size);
+}
+
 bool Packet::isValid(void) const
 {
 	return m_buffer != nullptr && m_length > 0;
@@ -147,11 +159,13 @@ void Packet::clear(void)
 {
 	if (m_buffer != nullptr)
 	{
-		delete[] m_buffer;
+		if (m_buffer != m_inlineBuffer && m_bufferCapacity > 0)
+			PacketPool::release(m_buffer, m_bufferCapacity);
 		m_buffer = nullptr;
 	}
 
 	m_bufferSize = 0;
+	m_bufferCapacity = 0;
 	m_position = 0;
 }
 
@@ -163,6 +177,38 @@ void Packet::copy(const Packet& other)
 	seek();
 }
 
+void Packet::setView(byte* data, uint length)
+{
+	ASSERT(data != nullptr);
+	ASSERT(length > 0);
+
+	clear();
+	m_buffer = data;
+	m_bufferSize = length;
+	m_bufferCapacity = 0;
+	m_length = length;
+}
+
+byte* Packet::lockAppend(uint size)
+{
+	ASSERT(size > 0);
+
+	const uint length = m_length;
+	const uint position = m_position;
+	if ((length + size) > m_bufferSize)
+		resize(length + size);
+
+	m_length = length;
+	m_position = position;
+	return &m_buffer[length];
+}
+
+void Packet::unlockAppend(uint size)
+{
+	ASSERT((m_length + size) <= m_bufferSize);
+	m_length += size;
+}
+
 void Packet::expand(uint size)
 {
 	if (size < PACKET_BUFFERGROWTH)
@@ -178,14 +224,31 @@ void Packet::resize(uint newsize)
 	ASSERT(newsize > 0);
 	if ( newsize > m_bufferSize )		// increase buffer, copying the contents
 	{
-		byte* buffer = new byte[newsize];
-		if (m_buffer != nullptr)
+		if ( newsize > m_bufferCapacity )	// the memory block is too small, move to a bigger one
 		{
-			memcpy(buffer, m_buffer, m_bufferSize);
-			delete[] m_buffer;
+			byte* buffer;
+			size_t capacity;
+			if (newsize <= PACKET_INLINEBUFFER)
+			{
+				buffer = m_inlineBuffer;
+				capacity = PACKET_INLINEBUFFER;
+			}
+			else
+			{
+				buffer = static_cast<byte*>(PacketPool::allocate(newsize, &capacity));
+			}
+
+			if (m_buffer != nullptr)
+			{
+				memcpy(buffer, m_buffer, m_bufferSize);
+				if (m_buffer != m_inlineBuffer && m_bufferCapacity > 0)
+					PacketPool::release(m_buffer, m_bufferCapacity);
+			}
+
+			m_buffer = buffer;
+			m_bufferCapacity = (uint)capacity;
 		}
-		
-		m_buffer = buffer;
+
 		m_bufferSize = newsize;
 		m_length = m_bufferSize;
 	}
@@ -1200,7 +1263,8 @@ bool Packet::onReceive(CNetState* client)
  *
  ***************************************************************************/
 PacketSend::PacketSend(byte id, uint len, Priority priority)
-	: m_priority(priority), m_target(nullptr), m_lengthPosition(0)
+	: m_priority(priority), m_target(nullptr), m_lengthPosition(0), m_coalesceUID(0), m_coalesceGeneration(0),
+	m_buildStartTime(PacketStats::isEnabled() ? CSTime::GetPreciseSysTimeMicro() : 0)
 {
 	if (len > 0)
 		resize(len);
@@ -1215,6 +1279,9 @@ PacketSend::PacketSend(const PacketSend *other)
 	m_priority = other->m_priority;
 	m_lengthPosition = other->m_lengthPosition;
 	m_position = other->m_position;
+	m_coalesceUID = other->m_coalesceUID;
+	m_coalesceGeneration = 0;
+	m_buildStartTime = other->m_buildStartTime;	// the clone is queued, the build time is the one of the original
 }
 
 void PacketSend::initLength(void)
@@ -11,6 +11,7 @@
 
 #define NETWORK_MAXPACKETS		g_Cfg.m_iNetMaxPacketsPerTick	// max packets to send per tick (per queue)
 #define NETWORK_MAXPACKETLEN	g_Cfg.m_iNetMaxLengthPerTick	// max packet length to send per tick (per queue)
+#define PACKET_INLINEBUFFER		64								// packets up to this size keep their data inside the object
 
 
 class CClient;
@@ -42,17 +43,24 @@ class Packet
 protected:
 	byte* m_buffer;				// raw data
 	uint m_bufferSize;		// size of raw data
+	uint m_bufferCapacity;	// size of the memory block holding the raw data (0 = data not owned, see setView)
 
 	uint m_length;			// length of packet
 	uint m_position;			// current position in packet
 	uint m_expectedLength;	// expected length of this packet (0 = dynamic)
 
+	byte m_inlineBuffer[PACKET_INLINEBUFFER];	// raw data storage for small packets
+
 public:
 	explicit Packet(uint size = 0);
 	Packet(const Packet& other);
 	Packet(const byte* data, uint size);
 	virtual ~Packet(void);
 
+	// packet objects are recycled through PacketPool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+
 private:
 	Packet& operator=(const Packet& other);
 
@@ -65,6 +73,10 @@ public:
 	uint getRemainingLength(void) const; // get length of data from current position
 	void dump(AbstractString& output) const; // write packet data to string
 
+	void setView(byte* data, uint length); // refer to data owned elsewhere instead of copying it (growing the packet moves it to a private buffer)
+	byte* lockAppend(uint size); // get space to write size bytes after the end of the packet
+	void unlockAppend(uint size); // append size bytes written to the space given by lockAppend
+
 	void expand(uint size = 0); // expand packet (resize whilst maintaining position)
 	void resize(uint newsize); // resize packet
 	void seek(uint pos = 0); // seek to position
@@ -156,6 +168,9 @@ protected:
 	int m_priority; // packet priority
 	CNetState* m_target; // selected network target for this packet
 	uint m_lengthPosition; // position of length-byte
+	dword m_coalesceUID; // object whose state this packet describes, superseded by a later packet with same id and uid (0 = never)
+	dword m_coalesceGeneration; // generation assigned when queued as supersedable (0 = not tracked)
+	llong m_buildStartTime; // time the packet started being built, in microseconds (0 = not tracked)
 
 public:
 	explicit PacketSend(byte id, uint len = 0, Priority priority = PRI_NORMAL);
@@ -185,6 +200,7 @@ public:
 
 protected:
 	void fixLength(); // write correct packet length to it's slot
+	void setCoalesceUID(dword uid) { m_coalesceUID = uid; }; // mark packet as supersedable by newer packets for the same object
 	virtual PacketSend* clone(void) const;
 };
 
@@ -250,26 +250,15 @@ bool PacketMovementReq::onReceive(CNetState* net)
 {
 	ADDTOCALLSTACK("PacketMovementReq::onReceive");
 
-	CClient *client = net->getClient();
-	ASSERT(client);
+	ASSERT(net->getClient());
 
 	byte direction = readByte();
 	byte sequence = readByte();
 	//dword crypt = readInt32();	// client fastwalk crypt (not used anymore)
 
-	if ( net->m_sequence == 0 && sequence != 0 )
-		direction = DIR_QTY;	// setting invalid direction to intentionally reject the walk request
-
-	if ( client->Event_Walk(direction, sequence) )
-	{
-		if ( sequence == UINT8_MAX )
-			sequence = 0;
-		net->m_sequence = ++sequence;
-	}
-	else
-	{
-		net->m_sequence = 0;
-	}
+	// the request is checked and queued here, the world thread will process all the
+	// queued steps at once (CClient::Event_WalkSteps)
+	net->queueWalkStep(direction, sequence);
 	return true;
 }
 
@@ -321,7 +310,7 @@ bool PacketSpeakReq::onReceive(CNetState* net)
  *
  *
  ***************************************************************************/
-PacketAttackReq::PacketAttackReq() : Packet(5)
+PacketAttackReq::PacketAttackReq() : Packet(kuiLength)
 {
 }
 
@@ -922,7 +911,7 @@ bool PacketMapEdit::onReceive(CNetState* net)
  *
  *
  ***************************************************************************/
-PacketCharPlay::PacketCharPlay() : Packet(73)
+PacketCharPlay::PacketCharPlay() : Packet(kuiLength)
 {
 }
 
@@ -1285,7 +1274,7 @@ bool PacketBulletinBoardReq::onReceive(CNetState* net)
  *
  *
  ***************************************************************************/
-PacketWarModeReq::PacketWarModeReq() : Packet(5)
+PacketWarModeReq::PacketWarModeReq() : Packet(kuiLength)
 {
 }
 
@@ -1422,7 +1411,7 @@ bool PacketMenuChoice::onReceive(CNetState* net)
  *
  *
  ***************************************************************************/
-PacketServersReq::PacketServersReq() : Packet(62)
+PacketServersReq::PacketServersReq() : Packet(kuiLength)
 {
 }
 
@@ -1656,7 +1645,7 @@ bool PacketCreateNew::onReceive(CNetState* net)
  *
  *
  ***************************************************************************/
-PacketCharListReq::PacketCharListReq() : Packet(65)
+PacketCharListReq::PacketCharListReq() : Packet(kuiLength)
 {
 }
 
@@ -1908,7 +1897,7 @@ bool PacketVendorSellReq::onReceive(CNetState* net)
  *
  *
  ***************************************************************************/
-PacketServerSelect::PacketServerSelect() : Packet(3)
+PacketServerSelect::PacketServerSelect() : Packet(kuiLength)
 {
 }
 
@@ -39,7 +39,9 @@ public:
 class PacketCreate : public Packet
 {
 public:
-	PacketCreate(uint size = 104);
+	static constexpr uint kuiLength = 104;	// expected length, PacketCreateNew and PacketCreateHS are longer
+
+	PacketCreate(uint size = kuiLength);
 	virtual bool onReceive(CNetState* net);
 
 protected:
@@ -59,7 +61,9 @@ protected:
 class PacketMovementReq : public Packet
 {
 public:
-	PacketMovementReq(uint size = 7);
+	static constexpr uint kuiLength = 7;
+
+	PacketMovementReq(uint size = kuiLength);
 	virtual bool onReceive(CNetState* net);
 };
 
@@ -87,6 +91,8 @@ public:
 class PacketAttackReq : public Packet
 {
 public:
+	static constexpr uint kuiLength = 5;
+
 	PacketAttackReq();
 	virtual bool onReceive(CNetState* net);
 };
@@ -299,6 +305,8 @@ public:
 class PacketCharPlay : public Packet
 {
 public:
+	static constexpr uint kuiLength = 73;
+
 	PacketCharPlay();
 	virtual bool onReceive(CNetState* net);
 };
@@ -369,6 +377,8 @@ public:
 class PacketWarModeReq : public Packet
 {
 public:
+	static constexpr uint kuiLength = 5;
+
 	PacketWarModeReq();
 	virtual bool onReceive(CNetState* net);
 };
@@ -425,6 +435,8 @@ public:
 class PacketServersReq : public Packet
 {
 public:
+	static constexpr uint kuiLength = 62;
+
 	PacketServersReq();
 	virtual bool onReceive(CNetState* net);
 };
@@ -467,6 +479,8 @@ public:
 class PacketCharListReq : public Packet
 {
 public:
+	static constexpr uint kuiLength = 65;
+
 	PacketCharListReq();
 	virtual bool onReceive(CNetState* net);
 };
@@ -565,6 +579,8 @@ public:
 class PacketServerSelect : public Packet
 {
 public:
+	static constexpr uint kuiLength = 3;
+
 	PacketServerSelect();
 	virtual bool onReceive(CNetState* net);
 };
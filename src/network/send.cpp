@@ -22,7 +22,11 @@
 #include "../game/CWorldGameTime.h"
 #include "CNetworkManager.h"
 #include "send.h"
+#include "../common/parallel_hashmap/phmap.h"
+#include "../common/sphere_library/smutex.h"
 #include "../common/zlib/zlib.h"
+#include <list>
+#include <memory>
 
 
 /***************************************************************************
@@ -127,6 +131,7 @@ PacketObjectStatus::PacketObjectStatus(const CClient* target, CObjBase* object)
 {
 	ADDTOCALLSTACK("PacketObjectStatus::PacketObjectStatus");
     ASSERT(object);
+    setCoalesceUID(object->GetUID());
 
 	const CNetState * state = target->GetNetState();
 	const CChar *character = target->GetChar();
@@ -373,6 +378,7 @@ void PacketObjectStatus::WriteVersionSpecific(const CClient* target, CChar* othe
 PacketHealthBarUpdateNew::PacketHealthBarUpdateNew(const CClient* target, const CChar* character) : PacketSend(XCMD_HealthBarColorNew, 12, g_Cfg.m_fUsePacketPriorities ? PRI_LOW : PRI_NORMAL), m_character(character->GetUID())
 {
     ADDTOCALLSTACK("PacketHealthBarUpdateNew::PacketHealthBarUpdateNew");
+    setCoalesceUID(m_character);
 
     word wColor = 0;
     if ( character->IsStatFlag(STATF_POISONED) )
@@ -409,6 +415,7 @@ bool PacketHealthBarUpdateNew::onSend(const CClient* client)
 PacketHealthBarUpdate::PacketHealthBarUpdate(const CClient* target, const CChar* character) : PacketSend(XCMD_HealthBarColor, 15, g_Cfg.m_fUsePacketPriorities? PRI_LOW : PRI_NORMAL), m_character(character->GetUID())
 {
 	ADDTOCALLSTACK("PacketHealthBarUpdate::PacketHealthBarUpdate");
+	setCoalesceUID(m_character);
 
 	initLength();
 
@@ -1501,7 +1508,7 @@ PacketGlobalLight::PacketGlobalLight(const CClient* target, byte light) : Packet
  *
  *
  ***************************************************************************/
-PacketWarningMessage::PacketWarningMessage(const CClient* target, PacketWarningMessage::Message code) : PacketSend(XCMD_IdleWarning, 2, PRI_NORMAL)
+PacketWarningMessage::PacketWarningMessage(const CClient* target, PacketWarningMessage::Message code) : PacketSend(XCMD_IdleWarning, kuiLength, PRI_NORMAL)
 {
 	ADDTOCALLSTACK("PacketWarningMessage::PacketWarningMessage");
 
@@ -2346,6 +2353,7 @@ PacketZoneChange::PacketZoneChange(const CClient* target, const CPointMap& pos)
 PacketCharacterMove::PacketCharacterMove(const CClient* target, const CChar* character, byte direction) : PacketSend(XCMD_CharMove, 17, PRI_NORMAL)
 {
 	ADDTOCALLSTACK("PacketCharacterMove::PacketCharacterMove");
+	setCoalesceUID(character->GetUID());
 	// NOTE: This packet move characters on screen, but can't move the
 	// client char receiving the packet (use packet 0x20 instead).
 
@@ -2534,7 +2542,7 @@ PacketChangeCharacter::PacketChangeCharacter(CClient* target) : PacketSend(XCMD_
  *
  *
  ***************************************************************************/
-PacketLoginError::PacketLoginError(const CClient* target, PacketLoginError::Reason reason) : PacketSend(XCMD_LogBad, 2, PRI_HIGHEST)
+PacketLoginError::PacketLoginError(const CClient* target, PacketLoginError::Reason reason) : PacketSend(XCMD_LogBad, kuiLength, PRI_HIGHEST)
 {
 	ADDTOCALLSTACK("PacketLoginError::PacketLoginError");
 
@@ -2763,7 +2771,7 @@ PacketSignGump::PacketSignGump(const CClient* target, const CObjBase* object, GU
  *
  *
  ***************************************************************************/
-PacketServerRelay::PacketServerRelay(const CClient* target, dword ip, word port, dword customerId) : PacketSend(XCMD_Relay, 11, g_Cfg.m_fUsePacketPriorities? PRI_IDLE : PRI_NORMAL)
+PacketServerRelay::PacketServerRelay(const CClient* target, dword ip, word port, dword customerId) : PacketSend(XCMD_Relay, kuiLength, g_Cfg.m_fUsePacketPriorities? PRI_IDLE : PRI_NORMAL)
 {
 	ADDTOCALLSTACK("PacketServerRelay::PacketServerRelay");
 	m_customerId = customerId;
@@ -3092,6 +3100,7 @@ uint PacketVendorSellList::fillSellList(CClient* target, const CItemContainer* c
 PacketHealthUpdate::PacketHealthUpdate(const CChar* character, bool full) : PacketSend(XCMD_StatChngStr, 9, g_Cfg.m_fUsePacketPriorities? PRI_LOW : PRI_NORMAL)
 {
 	ADDTOCALLSTACK("PacketHealthUpdate::PacketHealthUpdate");
+	setCoalesceUID(character->GetUID());
 
 	writeInt32(character->GetUID());
 
@@ -3119,6 +3128,7 @@ PacketHealthUpdate::PacketHealthUpdate(const CChar* character, bool full) : Pack
 PacketManaUpdate::PacketManaUpdate(const CChar* character, bool full) : PacketSend(XCMD_StatChngInt, 9, g_Cfg.m_fUsePacketPriorities? PRI_LOW : PRI_NORMAL)
 {
 	ADDTOCALLSTACK("PacketManaUpdate::PacketManaUpdate");
+	setCoalesceUID(character->GetUID());
 
 	writeInt32(character->GetUID());
 
@@ -3146,6 +3156,7 @@ PacketManaUpdate::PacketManaUpdate(const CChar* character, bool full) : PacketSe
 PacketStaminaUpdate::PacketStaminaUpdate(const CChar* character, bool full) : PacketSend(XCMD_StatChngDex, 9, g_Cfg.m_fUsePacketPriorities? PRI_LOW : PRI_NORMAL)
 {
 	ADDTOCALLSTACK("PacketStaminaUpdate::PacketStaminaUpdate");
+	setCoalesceUID(character->GetUID());
 
 	writeInt32(character->GetUID());
 
@@ -3535,6 +3546,127 @@ PacketDeath::PacketDeath(CChar* dead, CItemCorpse* corpse, bool fFrontFall) : Pa
 }
 
 
+/***************************************************************************
+ *
+ *
+ *	class GumpSectionCache		Keeps the compressed sections of recently sent gumps
+ *
+ *	Many dialogs (help menus, vendor menus, ...) are identical for every player,
+ *	so the control and text sections are looked up by content before deflating
+ *	them again. The least recently used sections are dropped first.
+ *
+ *
+ ***************************************************************************/
+#define GUMPCACHE_MAXBYTES	(2 * 1024 * 1024)	// max bytes (plain + compressed) held by the gump section cache
+
+namespace
+{
+	struct GumpSection
+	{
+		std::vector<byte> plain;		// uncompressed data, to tell apart sections with the same checksum
+		std::vector<byte> compressed;	// deflated data
+		int level;						// compression level used
+
+		size_t getSize() const
+		{
+			return plain.size() + compressed.size();
+		}
+	};
+	typedef std::shared_ptr<const GumpSection> GumpSectionPtr;
+
+	class GumpSectionCache
+	{
+	private:
+		typedef std::list<std::pair<dword, GumpSectionPtr>> SectionList;
+		SectionList m_sections;								// most recently used first
+		phmap::flat_hash_map<dword, SectionList::iterator> m_index;	// sections by checksum
+		size_t m_bytes;
+		SimpleMutex m_mutex;
+
+	public:
+		GumpSectionCache() : m_bytes(0) { }
+
+	private:
+		GumpSectionCache(const GumpSectionCache& copy);
+		GumpSectionCache& operator=(const GumpSectionCache& other);
+
+	public:
+		GumpSectionPtr find(dword checksum, const byte* data, uint length, int level)
+		{
+			SimpleThreadLock lock(m_mutex);
+			auto it = m_index.find(checksum);
+			if (it == m_index.end())
+				return nullptr;
+
+			const GumpSectionPtr section = it->second->second;
+			if (section->level != level || section->plain.size() != length || memcmp(section->plain.data(), data, length) != 0)
+				return nullptr;
+
+			m_sections.splice(m_sections.begin(), m_sections, it->second);
+			return section;
+		}
+
+		void insert(dword checksum, const GumpSectionPtr& section)
+		{
+			if (section->getSize() > (GUMPCACHE_MAXBYTES / 4))
+				return;
+
+			SimpleThreadLock lock(m_mutex);
+			auto it = m_index.find(checksum);
+			if (it != m_index.end())
+			{
+				// a different section with the same checksum, or compressed with another level
+				m_bytes -= it->second->second->getSize();
+				m_sections.erase(it->second);
+				m_index.erase(it);
+			}
+
+			m_sections.emplace_front(checksum, section);
+			m_index[checksum] = m_sections.begin();
+			m_bytes += section->getSize();
+
+			while (m_bytes > GUMPCACHE_MAXBYTES)
+			{
+				const SectionList::value_type& oldest = m_sections.back();
+				m_bytes -= oldest.second->getSize();
+				m_index.erase(oldest.first);
+				m_sections.pop_back();
+			}
+		}
+	};
+
+	GumpSectionCache g_GumpSectionCache;
+
+	GumpSectionPtr GetCompressedGumpSection(const byte* data, uint length)
+	{
+		const int level = g_Cfg.m_iGumpCompressionLevel;
+		const dword checksum = (dword)z_crc32(z_crc32(0L, Z_NULL, 0), data, (z_uInt)length);
+
+		GumpSectionPtr section = g_GumpSectionCache.find(checksum, data, length, level);
+		if (section != nullptr)
+			return section;
+
+		std::shared_ptr<GumpSection> newSection = std::make_shared<GumpSection>();
+		z_uLong compressLength = z_compressBound((z_uLong)length);
+		newSection->compressed.resize(compressLength);
+
+		int error = z_compress2(newSection->compressed.data(), &compressLength, data, (z_uLong)length, level);
+		if (error != Z_OK || compressLength <= 0)
+		{
+			g_Log.EventError("Compress failed with error %d when generating gump. Using old packet.\n", error);
+			return nullptr;
+		}
+
+		newSection->compressed.resize(compressLength);
+		newSection->plain.assign(data, data + length);
+		newSection->level = level;
+
+		g_GumpSectionCache.insert(checksum, newSection);
+		return newSection;
+	}
+}
+
+
 /***************************************************************************
  *
  *
@@ -3590,26 +3722,18 @@ void PacketGumpDialog::writeCompressedControls(const CSString* controls, uint co
 
 		ASSERT(controlLengthActual == controlLength);
 
-		z_uLong compressLength = z_compressBound(controlLengthActual);
-		byte* compressBuffer = new byte[compressLength];
-
-		int error = z_compress2(compressBuffer, &compressLength, (byte*)toCompress, controlLengthActual, Z_DEFAULT_COMPRESSION);
+		const GumpSectionPtr section = GetCompressedGumpSection((byte*)toCompress, (uint)controlLengthActual);
 		delete[] toCompress;
 
-		if (error != Z_OK || compressLength <= 0)
+		if (section == nullptr)
 		{
-			delete[] compressBuffer;
-			g_Log.EventError("Compress failed with error %d when generating gump. Using old packet.\n", error);
-
 			writeStandardControls(controls, controlCount, texts, textCount);
 			return;
 		}
 
-		writeInt32(compressLength + 4);
+		writeInt32((dword)section->compressed.size() + 4);
 		writeInt32(controlLengthActual);
-		writeData(compressBuffer, compressLength);
-
-		delete[] compressBuffer;
+		writeData(section->compressed.data(), (uint)section->compressed.size());
 	}
 
 	{
@@ -3624,27 +3748,18 @@ void PacketGumpDialog::writeCompressedControls(const CSString* controls, uint co
 
 		uint textsLength = getPosition() - textsPosition;
 
-		z_uLong compressLength = z_compressBound((z_uLong)textsLength);
-		byte* compressBuffer = new byte[compressLength];
-
-		int error = z_compress2(compressBuffer, &compressLength, &m_buffer[textsPosition], (z_uLong)textsLength, Z_DEFAULT_COMPRESSION);
-		if (error != Z_OK || compressLength <= 0)
+		const GumpSectionPtr section = GetCompressedGumpSection(&m_buffer[textsPosition], textsLength);
+		if (section == nullptr)
 		{
-			delete[] compressBuffer;
-
-			g_Log.EventError("Compress failed with error %d when generating gump. Using old packet.\n", error);
-
 			writeStandardControls(controls, controlCount, texts, textCount);
 			return;
 		}
 
 		seek(textsPosition);
 		writeInt32((dword)textCount);
-		writeInt32(compressLength + 4);
+		writeInt32((dword)section->compressed.size() + 4);
 		writeInt32((dword)textsLength);
-		writeData(compressBuffer, compressLength);
-
-		delete[] compressBuffer;
+		writeData(section->compressed.data(), (uint)section->compressed.size());
 	}
 }
 
@@ -4745,36 +4860,55 @@ PacketHouseDesign::~PacketHouseDesign(void)
 	}
 }
 
-bool PacketHouseDesign::writePlaneData(int plane, int itemCount, byte* data, int dataSize)
+bool PacketHouseDesign::compressPlaneData(int plane, const byte* data, int dataSize, std::vector<byte>& compressed) const
 {
-	ADDTOCALLSTACK("PacketHouseDesign::writePlaneData");
+	ADDTOCALLSTACK("PacketHouseDesign::compressPlaneData");
 
 	// compress data
 	z_uLong compressLength = z_compressBound(dataSize);
-	byte* compressBuffer = new byte[compressLength];
+	compressed.resize(compressLength);
 
-	int error = z_compress2(compressBuffer, &compressLength, data, dataSize, Z_DEFAULT_COMPRESSION);
+	int error = z_compress2(compressed.data(), &compressLength, data, dataSize, Z_DEFAULT_COMPRESSION);
 	if ( error != Z_OK )
 	{
 		// an error occured with this floor, but we should be able to continue to the next without problems
-		delete[] compressBuffer;
+		compressed.clear();
 		g_Log.EventError("Compress failed with error %d when generating house design for floor %d on building 0%x.\n", error, plane, (dword)m_house->GetUID());
 		return false;
 	}
 	else if ( compressLength <= 0 || compressLength >= PLANEDATA_BUFFER )
 	{
 		// too much data, but we should be able to continue to the next floor without problems
-		delete[] compressBuffer;
+		compressed.clear();
 		g_Log.EventWarn("Floor %d on building 0%x too large with compressed length of %lu.\n", plane, (dword)m_house->GetUID(), compressLength);
 		return false;
 	}
 
+	compressed.resize(compressLength);
+	return true;
+}
+
+bool PacketHouseDesign::writePlaneData(int plane, int itemCount, byte* data, int dataSize)
+{
+	ADDTOCALLSTACK("PacketHouseDesign::writePlaneData");
+
+	std::vector<byte> compressed;
+	if ( !compressPlaneData(plane, data, dataSize, compressed) )
+		return false;
+
+	return writeCompressedPlaneData(plane, itemCount, dataSize, compressed.data(), (int)compressed.size());
+}
+
+bool PacketHouseDesign::writeCompressedPlaneData(int plane, int itemCount, int dataSize, const byte* compressed, int compressLength)
+{
+	ADDTOCALLSTACK("PacketHouseDesign::writeCompressedPlaneData");
+	// write plane data already compressed by compressPlaneData
+
 	writeByte((byte)(plane | 0x20));
 	writeByte((byte)(dataSize));
 	writeByte((byte)compressLength);
 	writeByte(((dataSize >> 4) & 0xF0) | ((compressLength >> 8) & 0x0F));
-	writeData(compressBuffer, compressLength);
-	delete[] compressBuffer;
+	writeData(compressed, compressLength);
 
 	m_planeCount++;
 	m_itemCount += itemCount;
@@ -4872,6 +5006,7 @@ PacketPropertyListVersion::PacketPropertyListVersion(const CClient* target, cons
 	ADDTOCALLSTACK("PacketPropertyListVersion::PacketPropertyListVersion");
 
 	m_object = object->GetUID();
+	setCoalesceUID(m_object);
 
 	writeInt32(m_object);
 	writeInt32(version);
@@ -519,6 +519,7 @@ public:
 		CharacterTransfer = 0x09,
 		InvalidName = 0x0A
 	};
+	static constexpr uint kuiLength = 2;
 
 	PacketWarningMessage(const CClient* target, Message code);
 };
@@ -883,6 +884,7 @@ public:
 
 		Success = 0xFF  // no error
 	};
+	static constexpr uint kuiLength = 2;
 
 	PacketLoginError(const CClient* target, Reason reason);
 };
@@ -981,6 +983,8 @@ private:
 	dword m_customerId;
 
 public:
+	static constexpr uint kuiLength = 11;
+
 	PacketServerRelay(const CClient* target, dword ip, word port, dword customerId);
 	virtual void onSent(CClient* client);
 };
@@ -1811,7 +1815,9 @@ public:
 	PacketHouseDesign(const PacketHouseDesign* other);
 	virtual ~PacketHouseDesign(void);
 
+	bool compressPlaneData(int plane, const byte* data, int dataSize, std::vector<byte>& compressed) const;
 	bool writePlaneData(int plane, int itemCount, byte* data, int dataSize);
+	bool writeCompressedPlaneData(int plane, int itemCount, int dataSize, const byte* compressed, int compressLength);
 	bool writeStairData(ITEMID_TYPE id, int x, int y, int z);
 	void flushStairData(void);
 	void finalise(void);
@@ -6,31 +6,46 @@
 #ifndef _INC_CONTAINERS_H
 #define _INC_CONTAINERS_H
 
-#include <list>
+#include <atomic>
+#include <deque>
+#include "../common/sphere_library/smutex.h"
 #include "../common/CException.h"
-// a thread-safe implementation of a queue container that doesn't use any locks
-// this only works as long as there is only a single reader thread and writer thread (can be different)
+// a thread-safe queue container for any number of writer threads and a single reader thread
+// elements are stored in a fixed size lock-free ring buffer (no allocations, O(1) size); should
+// the ring ever fill up, new elements spill to a locked overflow list until the reader drains it
 
 
-template<class T>
+template<class T, size_t TCapacity = 64>
 class ThreadSafeQueue
 {
-public:
-	typedef std::list<T> list;
-	typedef typename std::list<T>::iterator iterator;
-	typedef typename std::list<T>::const_iterator const_iterator;
+	static_assert((TCapacity >= 2) && ((TCapacity & (TCapacity - 1)) == 0), "ThreadSafeQueue capacity must be a power of 2");
 
 private:
-	list m_list;
-	iterator m_head;
-	iterator m_tail;
+	struct Cell
+	{
+		std::atomic<size_t> m_sequence;	// position this cell is ready for (== pos: writable, == pos+1: readable)
+		T m_value;
+	};
+
+	Cell m_cells[TCapacity];
+	std::atomic<size_t> m_tail;				// next ring position to be written (writers)
+	std::atomic<size_t> m_head;				// next ring position to be read (reader)
+
+	SimpleMutex m_overflowMutex;
+	std::deque<T> m_overflow;				// elements pushed while the ring was full
+	std::atomic<size_t> m_overflowCount;	// m_overflow.size(), readable without locking
+
+	T m_peeked;								// element taken by front() but not yet removed by pop() (reader)
+	std::atomic<bool> m_hasPeeked;
 
 public:
-	ThreadSafeQueue()
+	ThreadSafeQueue() : m_tail(0), m_head(0), m_overflowCount(0), m_peeked(), m_hasPeeked(false)
 	{
-		m_list.push_back( T() ); // at least one element must be in the queue
-		m_head = m_list.begin();
-		m_tail = m_list.end();
+		for ( size_t i = 0; i < TCapacity; ++i )
+		{
+			m_cells[i].m_sequence.store( i, std::memory_order_relaxed );
+			m_cells[i].m_value = T();
+		}
 	}
 
 private:
@@ -41,66 +56,116 @@ public:
 	// Append an element to the end of the queue (writer)
 	void push( const T& value )
 	{
-		m_list.push_back( value );
-		m_tail = m_list.end();
-		clean();
-	}
-
-	// Erase elements from before reader head (writer)
-	void clean( void )
-	{
-        m_head = m_list.erase( m_list.begin(), m_head );
+		// once elements have overflowed, keep using the overflow list until the reader has drained it,
+		// so that a writer can never overtake its own previous elements
+		if ( (m_overflowCount.load( std::memory_order_acquire ) == 0) && pushRing( value ) )
+			return;
+
+		SimpleThreadLock lock( m_overflowMutex );
+		m_overflow.push_back( value );
+		m_overflowCount.fetch_add( 1, std::memory_order_release );
 	}
 
 	// Retrieve the number of elements in the queue (reader/writer)
 	size_t size( void ) const
 	{
-		if ( empty() )
-			return 0;
-
-		size_t toSkip = 1;
-		for ( const_iterator it = m_list.begin(), end = m_list.end(); (it != m_head) && (it != end); ++it )
-			++toSkip;
-
-		return m_list.size() - toSkip;
+		const size_t head = m_head.load( std::memory_order_acquire );
+		const size_t tail = m_tail.load( std::memory_order_acquire );
+		const size_t ring = (tail > head) ? (tail - head) : 0;
+		return ring + m_overflowCount.load( std::memory_order_acquire ) + (m_hasPeeked.load( std::memory_order_acquire ) ? 1 : 0);
 	}
 
 	// Determine if the queue is empty (reader/writer)
 	bool empty( void ) const
 	{
-		iterator next = m_head;
-		++next;
+		if ( m_hasPeeked.load( std::memory_order_acquire ) || (m_overflowCount.load( std::memory_order_acquire ) > 0) )
+			return false;
 
-		return ( next == m_tail );
+		const size_t head = m_head.load( std::memory_order_acquire );
+		return ( m_cells[head & (TCapacity - 1)].m_sequence.load( std::memory_order_acquire ) != (head + 1) );
 	}
 
 	// Remove the first element from the queue (reader)
 	void pop( void )
 	{
-		if ( empty() )
+		if ( (m_hasPeeked.load( std::memory_order_relaxed ) == false) && (take( m_peeked ) == false) )
 			throw CSError( LOGL_ERROR, 0, "No elements to read from queue." );
 
-		iterator next = m_head;
-		++next;
-
-		if ( next != m_tail )
-			m_head = next;
+		m_peeked = T();
+		m_hasPeeked.store( false, std::memory_order_release );
 	}
 
 	// Retrieve the first element in the queue (reader)
-	T front( void ) const
+	T front( void )
 	{
-		if ( empty() == false )
+		if ( m_hasPeeked.load( std::memory_order_relaxed ) )
+			return m_peeked;
+
+		if ( take( m_peeked ) == false )
+			throw CSError( LOGL_ERROR, 0, "No elements to read from queue." );
+
+		// the element stays accounted in the queue until pop()
+		m_hasPeeked.store( true, std::memory_order_release );
+		return m_peeked;
+	}
+
+private:
+	bool pushRing( const T& value )
+	{
+		size_t pos = m_tail.load( std::memory_order_relaxed );
+		for (;;)
 		{
-			iterator next = m_head;
-			++next;
+			Cell& cell = m_cells[pos & (TCapacity - 1)];
+			const size_t sequence = cell.m_sequence.load( std::memory_order_acquire );
+			const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			if ( diff == 0 )
+			{
+				// cell is free, try to claim it
+				if ( m_tail.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+				{
+					cell.m_value = value;
+					cell.m_sequence.store( pos + 1, std::memory_order_release );
+					return true;
+				}
+			}
+			else if ( diff < 0 )
+			{
+				// ring is full
+				return false;
+			}
+			else
+			{
+				// another writer claimed this cell first
+				pos = m_tail.load( std::memory_order_relaxed );
+			}
+		}
+	}
 
-			if ( next != m_tail )
-				return *next;
+	bool take( T& value )
+	{
+		// ring elements always come first: the overflow list only holds elements pushed after the ring filled up
+		const size_t head = m_head.load( std::memory_order_relaxed );
+		Cell& cell = m_cells[head & (TCapacity - 1)];
+		if ( cell.m_sequence.load( std::memory_order_acquire ) == (head + 1) )
+		{
+			value = cell.m_value;
+			cell.m_value = T();
+			m_head.store( head + 1, std::memory_order_release );
+			cell.m_sequence.store( head + TCapacity, std::memory_order_release );
+			return true;
 		}
 
-		// this should never happen
-		throw CSError( LOGL_ERROR, 0, "No elements to read from queue." );
+		if ( m_overflowCount.load( std::memory_order_acquire ) == 0 )
+			return false;
+
+		SimpleThreadLock lock( m_overflowMutex );
+		if ( m_overflow.empty() )
+			return false;
+
+		value = m_overflow.front();
+		m_overflow.pop_front();
+		m_overflowCount.fetch_sub( 1, std::memory_order_release );
+		return true;
 	}
 };
 
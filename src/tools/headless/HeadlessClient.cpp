@@ -0,0 +1,560 @@
+#include "HeadlessClient.h"
+#include "../../network/receive.h"
+#include <algorithm>
+#include <cstdio>
+
+#define HEADLESS_RECVBUFFER		0x4000	// max data to receive at once
+#define HEADLESS_MOVETIMEOUT	5000	// time after which an unanswered walk request is considered lost (ms)
+#define HEADLESS_MAXMOBILES		64		// max other mobiles remembered as attack targets
+
+
+namespace headless
+{
+
+/***************************************************************************
+ *
+ *
+ *	class HeadlessClient		One bot connection
+ *
+ *
+ ***************************************************************************/
+HeadlessClient::HeadlessClient(const Settings& settings, Stats& stats, uint32_t index) :
+	m_settings(settings), m_stats(stats), m_index(index), m_state(STATE_IDLE), m_relayKey(0), m_relayPort(0),
+	m_serial(0), m_direction(0), m_sequence(0), m_moveSent(0), m_nextMove(0), m_speechSent(0), m_speechCount(0),
+	m_nextSpeech(0), m_nextAttack(0), m_warMode(false), m_random(index * 2654435761u + 1)
+{
+}
+
+bool HeadlessClient::start(int64_t now)
+{
+	(void)now;
+	m_input.clear();
+	m_decoder.reset();
+	if (!m_socket.connect(m_settings.host, m_settings.port))
+	{
+		m_state = STATE_CLOSED;
+		return false;
+	}
+
+	m_state = STATE_LOGIN;
+	return true;
+}
+
+void HeadlessClient::close(void)
+{
+	m_socket.close();
+	m_state = STATE_CLOSED;
+}
+
+void HeadlessClient::send(const PacketWriter& packet)
+{
+	ByteBuffer data = packet.getData();
+	if (!packet.isComplete())
+	{
+		fprintf(stderr, "Bot %u: packet 0x%02x doesn't match the length expected by the server.\n", m_index, data[0]);
+		close();
+		return;
+	}
+
+	if (!m_crypt.EncryptClient(data.data(), data.data(), (uint)data.size(), (uint)data.size()))
+	{
+		close();
+		return;
+	}
+	sendRaw(data.data(), data.size());
+}
+
+void HeadlessClient::sendRaw(const uint8_t* data, size_t length)
+{
+	m_stats.bytesSent += length;
+	if (!m_socket.send(data, length))
+		close();
+}
+
+bool HeadlessClient::initCrypt(uint32_t seed, CONNECT_TYPE type)
+{
+	// the keys of SphereCrypt.ini are those of the server, the version 0 is the "no encryption" one
+	const dword version = m_settings.encrypt ? (dword)CCrypto::GetVerFromNumber(m_settings.version[0], m_settings.version[1], m_settings.version[2], m_settings.version[3]) : 0;
+	if (m_crypt.InitClient(seed, version, type))
+		return true;
+
+	fprintf(stderr, "Bot %u: no usable encryption keys for client %u.%u.%u.%u.\n", m_index, m_settings.version[0], m_settings.version[1], m_settings.version[2], m_settings.version[3]);
+	++m_stats.loginFailures;
+	close();
+	return false;
+}
+
+void HeadlessClient::onWritable(int64_t now)
+{
+	(void)now;
+	if (m_socket.isConnecting())
+	{
+		if (!m_socket.finishConnect())
+		{
+			++m_stats.loginFailures;
+			close();
+			return;
+		}
+
+		onConnected();
+	}
+
+	if (m_socket.isOpen() && !m_socket.flush())
+		close();
+}
+
+void HeadlessClient::onConnected(void)
+{
+	if (m_state == STATE_LOGIN)
+	{
+		// new style seed, reporting the client version (not encrypted)
+		const uint32_t seedValue = 0x01000000 | (m_index + 1);
+		if (!initCrypt(seedValue, CONNECT_LOGIN))
+			return;
+
+		PacketWriter seed(XCMD_NewSeed, SEEDLENGTH_NEW);
+		seed.writeInt32(seedValue);
+		for (int i = 0; i < 4; ++i)
+			seed.writeInt32(m_settings.version[i]);
+		sendRaw(seed.getData().data(), seed.getData().size());
+
+		PacketWriter login(XCMD_ServersReq, PacketServersReq::kuiLength);
+		login.writeString(getAccountName(), MAX_ACCOUNT_NAME_SIZE);
+		login.writeString(m_settings.password, MAX_NAME_SIZE);
+		login.writeByte(0x5D);
+		send(login);
+	}
+	else if (m_state == STATE_GAMELOGIN)
+	{
+		// old style seed (the relay key, not encrypted), then the game login
+		if (!initCrypt(m_relayKey, CONNECT_GAME))
+			return;
+
+		const uint8_t key[SEEDLENGTH_OLD] = { (uint8_t)(m_relayKey >> 24), (uint8_t)(m_relayKey >> 16), (uint8_t)(m_relayKey >> 8), (uint8_t)(m_relayKey) };
+		sendRaw(key, sizeof(key));
+
+		PacketWriter login(XCMD_CharListReq, PacketCharListReq::kuiLength);
+		login.writeInt32(m_relayKey);
+		login.writeString(getAccountName(), MAX_ACCOUNT_NAME_SIZE);
+		login.writeString(m_settings.password, MAX_NAME_SIZE);
+		send(login);
+		if (m_state != STATE_CLOSED)
+			m_state = STATE_CHARLIST;
+	}
+}
+
+void HeadlessClient::onReadable(int64_t now)
+{
+	uint8_t buffer[HEADLESS_RECVBUFFER];
+	for (;;)
+	{
+		const int received = m_socket.receive(buffer, sizeof(buffer));
+		if (received == 0)
+			return;
+		if (received < 0)
+		{
+			if (m_state < STATE_INWORLD)
+				++m_stats.loginFailures;
+			close();
+			return;
+		}
+
+		m_stats.bytesReceived += (uint64_t)received;
+		if (m_state == STATE_LOGIN || m_state == STATE_RELAY)
+		{
+			// the login server doesn't compress its packets
+			m_input.insert(m_input.end(), buffer, buffer + received);
+			size_t offset = 0;
+			while (offset < m_input.size() && (m_state == STATE_LOGIN || m_state == STATE_RELAY))
+			{
+				size_t length = 0;
+				if (!GetLoginPacketLength(m_input[offset], length))
+				{
+					fprintf(stderr, "Bot %u: unexpected packet 0x%02x from the login server.\n", m_index, m_input[offset]);
+					++m_stats.loginFailures;
+					close();
+					return;
+				}
+
+				if (length == 0)
+				{
+					if (m_input.size() - offset < 3)
+						break;
+					length = (size_t)((m_input[offset + 1] << 8) | m_input[offset + 2]);
+				}
+				if (length == 0 || m_input.size() - offset < length)
+					break;
+
+				++m_stats.packetsReceived;
+				onLoginPacket(&m_input[offset], length);
+				offset += length;
+			}
+
+			if (m_state == STATE_CLOSED)
+				return;
+			if (m_state == STATE_LOGIN || m_state == STATE_RELAY)
+			{
+				m_input.erase(m_input.begin(), m_input.begin() + offset);
+				continue;
+			}
+
+			// relayed, the login connection is gone
+			m_input.clear();
+			return;
+		}
+
+		if (!m_crypt.DecryptClient(buffer, buffer, (uint)received, (uint)received))
+		{
+			close();
+			return;
+		}
+
+		std::vector<ByteBuffer> packets;
+		m_decoder.decode(buffer, (size_t)received, packets);
+		for (const ByteBuffer& packet : packets)
+		{
+			if (packet.empty())
+				continue;
+
+			++m_stats.packetsReceived;
+			onGamePacket(packet.data(), packet.size(), now);
+			if (m_state == STATE_CLOSED)
+				return;
+		}
+	}
+}
+
+void HeadlessClient::onLoginPacket(const uint8_t* data, size_t length)
+{
+	PacketReader reader(data, length);
+	switch (reader.readByte())
+	{
+		case XCMD_ServerList:	// pick the first one
+		{
+			PacketWriter select(XCMD_ServerSelect, PacketServerSelect::kuiLength);
+			select.writeInt16(0);
+			send(select);
+			m_state = STATE_RELAY;
+			break;
+		}
+
+		case XCMD_Relay:	// to the game server (its address is ignored, connect to the same host)
+		{
+			reader.skip(4);
+			m_relayPort = reader.readInt16();
+			m_relayKey = reader.readInt32();
+
+			m_socket.close();
+			if (!m_socket.connect(m_settings.host, m_relayPort))
+			{
+				++m_stats.loginFailures;
+				close();
+				return;
+			}
+			m_state = STATE_GAMELOGIN;
+			break;
+		}
+
+		case XCMD_IdleWarning:
+		case XCMD_LogBad:	// login rejected
+			fprintf(stderr, "Bot %u: login rejected (reason %u).\n", m_index, (unsigned)reader.readByte());
+			++m_stats.loginFailures;
+			close();
+			break;
+
+		default:
+			break;
+	}
+}
+
+void HeadlessClient::onGamePacket(const uint8_t* data, size_t length, int64_t now)
+{
+	PacketReader reader(data, length);
+	switch (reader.readByte())
+	{
+		case XCMD_Start:	// login confirm
+			m_serial = reader.readInt32();
+			reader.skip(4 + 2 + 2 + 2 + 1 + 1);
+			m_direction = reader.readByte() & 0x07;
+			break;
+
+		case XCMD_LoginComplete:
+			onEnterWorld(now);
+			break;
+
+		case XCMD_CharList:
+			if (m_state == STATE_CHARLIST)
+				onCharList(reader);
+			break;
+
+		case XCMD_ClientVersion:	// request
+		{
+			char version[64];
+			snprintf(version, sizeof(version), "%u.%u.%u.%u", m_settings.version[0], m_settings.version[1], m_settings.version[2], m_settings.version[3]);
+			PacketWriter reply(XCMD_ClientVersion, 0);
+			reply.writeInt16(0);
+			reply.writeStringNull(version);
+			reply.finaliseLength();
+			send(reply);
+			break;
+		}
+
+		case XCMD_PlayerUpdate:	// draw player, the walk sequence starts again from 0
+			if (reader.readInt32() == m_serial)
+			{
+				reader.skip(2 + 1 + 2 + 1 + 2 + 2 + 2);
+				m_direction = reader.readByte() & 0x07;
+				m_sequence = 0;
+			}
+			break;
+
+		case XCMD_WalkReject:
+			reader.skip(1 + 2 + 2);
+			m_direction = reader.readByte() & 0x07;
+			m_sequence = 0;
+			if (m_moveSent != 0)
+			{
+				++m_stats.moves.rejected;
+				m_stats.moves.add(now - m_moveSent);
+				m_moveSent = 0;
+			}
+			break;
+
+		case XCMD_WalkAck:
+		{
+			const uint8_t sequence = reader.readByte();
+			m_sequence = (sequence == 0xFF) ? 1 : (uint8_t)(sequence + 1);
+			if (m_moveSent != 0)
+			{
+				m_stats.moves.add(now - m_moveSent);
+				m_moveSent = 0;
+			}
+			break;
+		}
+
+		case XCMD_Speak:
+		case XCMD_SpeakUNICODE:
+			if (reader.readInt16() > 0 && reader.readInt32() == m_serial && m_speechSent != 0)
+			{
+				m_stats.speech.add(now - m_speechSent);
+				m_speechSent = 0;
+			}
+			break;
+
+		case XCMD_CharMove:	// mobile moving
+			addMobile(reader.readInt32());
+			break;
+
+		case XCMD_Char:	// mobile appearing
+			reader.skip(2);
+			addMobile(reader.readInt32());
+			break;
+
+		case XCMD_Remove:	// object removed
+			removeMobile(reader.readInt32());
+			break;
+
+		case XCMD_LogBad:	// login rejected
+			fprintf(stderr, "Bot %u: game login rejected (reason %u).\n", m_index, (unsigned)reader.readByte());
+			++m_stats.loginFailures;
+			close();
+			break;
+
+		default:
+			break;
+	}
+}
+
+void HeadlessClient::onCharList(PacketReader& reader)
+{
+	reader.skip(2);
+	const uint8_t count = reader.readByte();
+	for (uint8_t slot = 0; slot < count; ++slot)
+	{
+		const std::string name = reader.readString(MAX_NAME_SIZE);
+		reader.skip(MAX_NAME_SIZE);
+		if (name.empty())
+			continue;
+
+		PacketWriter play(XCMD_CharPlay, PacketCharPlay::kuiLength);
+		play.writeInt32(0xEDEDEDED);
+		play.writeString(name, MAX_NAME_SIZE);
+		play.fill(MAX_NAME_SIZE);
+		play.writeInt32(slot);
+		play.writeInt32(0x7F000001);
+		send(play);
+		m_state = STATE_ENTERING;
+		return;
+	}
+
+	// new account, create a character (the server validates stats and skills on its own)
+	char name[MAX_NAME_SIZE];
+	snprintf(name, sizeof(name), "Bot%u", m_index);
+
+	PacketWriter create(XCMD_Create, PacketCreate::kuiLength);
+	create.writeInt32(0xEDEDEDED);
+	create.writeInt32(0xFFFFFFFF);
+	create.writeByte(0);
+	create.writeString(name, MAX_NAME_SIZE);
+	create.fill(2);
+	create.writeInt32(0);		// flags
+	create.fill(8);
+	create.writeByte(PROFESSION_ADVANCED);
+	create.fill(15);
+	create.writeByte((m_settings.version[0] >= 7) ? 2 : 0);	// human male (race_sex_flag of PacketCreate::onReceive)
+	create.writeByte(60);		// str
+	create.writeByte(10);		// dex
+	create.writeByte(10);		// int
+	create.writeByte(1);		// skills
+	create.writeByte(50);
+	create.writeByte(27);
+	create.writeByte(50);
+	create.writeByte(40);
+	create.writeByte(0);
+	create.writeInt16(0x83EA);	// skin hue
+	create.writeInt16(0x203B);	// hair
+	create.writeInt16(0x044E);
+	create.writeInt16(0);		// beard
+	create.writeInt16(0);
+	create.writeByte(0);		// shard index
+	create.writeByte(0);		// start location
+	create.writeInt32(0);		// slot
+	create.writeInt32(0x7F000001);
+	create.writeInt16(0x0003);	// shirt hue
+	create.writeInt16(0x0003);	// pants hue
+	send(create);
+	m_state = STATE_ENTERING;
+}
+
+void HeadlessClient::onEnterWorld(int64_t now)
+{
+	if (m_state == STATE_INWORLD)
+		return;
+
+	m_state = STATE_INWORLD;
+
+	// spread the first requests, so bots logged in together don't keep acting together
+	const int64_t nowMs = now / 1000;
+	if (m_settings.moveInterval > 0)
+		m_nextMove = nowMs + (random() % m_settings.moveInterval);
+	if (m_settings.speechInterval > 0)
+		m_nextSpeech = nowMs + (random() % m_settings.speechInterval);
+	if (m_settings.combatInterval > 0)
+		m_nextAttack = nowMs + (random() % m_settings.combatInterval);
+}
+
+void HeadlessClient::tick(int64_t now)
+{
+	if (m_state != STATE_INWORLD)
+		return;
+
+	const int64_t nowMs = now / 1000;
+	// one walk request at a time, so each answer matches its request
+	if (m_settings.moveInterval > 0 && nowMs >= m_nextMove && (m_moveSent == 0 || (now - m_moveSent) >= (HEADLESS_MOVETIMEOUT * 1000)))
+	{
+		m_nextMove = nowMs + m_settings.moveInterval;
+		sendWalk(now);
+	}
+
+	if (m_settings.speechInterval > 0 && nowMs >= m_nextSpeech)
+	{
+		m_nextSpeech = nowMs + m_settings.speechInterval;
+		sendSpeech(now);
+	}
+
+	if (m_settings.combatInterval > 0 && nowMs >= m_nextAttack)
+	{
+		m_nextAttack = nowMs + m_settings.combatInterval;
+		sendAttack();
+	}
+}
+
+void HeadlessClient::sendWalk(int64_t now)
+{
+	// mostly keep going straight, changing direction costs a request on its own
+	if ((random() % 8) == 0)
+		m_direction = (uint8_t)(random() % 8);
+
+	PacketWriter walk(XCMD_WalkRequest, PacketMovementReq::kuiLength);
+	walk.writeByte(m_direction);
+	walk.writeByte(m_sequence);
+	walk.writeInt32(0);		// fastwalk key
+	send(walk);
+
+	++m_stats.moves.sent;
+	m_moveSent = now;
+}
+
+void HeadlessClient::sendSpeech(int64_t now)
+{
+	char text[64];
+	snprintf(text, sizeof(text), "bot %u line %u", m_index, ++m_speechCount);
+
+	PacketWriter speech(XCMD_Talk, 0);
+	speech.writeInt16(0);
+	speech.writeByte(TALKMODE_SAY);
+	speech.writeInt16(0x03B2);	// hue
+	speech.writeInt16(3);		// font
+	speech.writeStringNull(text);
+	speech.finaliseLength();
+	send(speech);
+
+	++m_stats.speech.sent;
+	m_speechSent = now;
+}
+
+void HeadlessClient::sendAttack(void)
+{
+	if (m_mobiles.empty())
+		return;
+
+	if (!m_warMode)
+	{
+		PacketWriter war(XCMD_War, PacketWarModeReq::kuiLength);
+		war.writeByte(1);
+		war.writeByte(0x00);
+		war.writeByte(0x32);
+		war.writeByte(0x00);
+		send(war);
+		m_warMode = true;
+	}
+
+	PacketWriter attack(XCMD_Attack, PacketAttackReq::kuiLength);
+	attack.writeInt32(m_mobiles[random() % m_mobiles.size()]);
+	send(attack);
+	++m_stats.attacks;
+}
+
+void HeadlessClient::addMobile(uint32_t serial)
+{
+	if (serial == m_serial || (serial & 0x40000000) != 0)
+		return;
+	if (std::find(m_mobiles.begin(), m_mobiles.end(), serial) != m_mobiles.end())
+		return;
+	if (m_mobiles.size() >= HEADLESS_MAXMOBILES)
+		m_mobiles.erase(m_mobiles.begin());
+	m_mobiles.push_back(serial);
+}
+
+void HeadlessClient::removeMobile(uint32_t serial)
+{
+	std::vector<uint32_t>::iterator it = std::find(m_mobiles.begin(), m_mobiles.end(), serial);
+	if (it != m_mobiles.end())
+		m_mobiles.erase(it);
+}
+
+uint32_t HeadlessClient::random(void)
+{
+	// xorshift, one generator per bot
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return m_random;
+}
+
+std::string HeadlessClient::getAccountName(void) const
+{
+	return m_settings.accountPrefix + std::to_string(m_index);
+}
+
+} // namespace headless
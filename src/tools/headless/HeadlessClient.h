@@ -0,0 +1,146 @@
+/**
+* @file HeadlessClient.h
+* @brief A synthetic game client (bot) for load testing a server.
+*/
+
+#ifndef _INC_HEADLESSCLIENT_H
+#define _INC_HEADLESSCLIENT_H
+
+#include "HeadlessProtocol.h"
+#include "HeadlessSocket.h"
+#include "../../common/crypto/CCrypto.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace headless
+{
+
+struct Settings
+{
+	std::string host;			// server address
+	uint16_t port;				// login server port
+	std::string accountPrefix;	// bot accounts are named <prefix><index>
+	std::string password;
+	uint32_t version[4];		// reported client version
+	bool encrypt;				// encrypt like the client version does (keys from sphereCrypt.ini), otherwise don't encrypt at all
+	int64_t moveInterval;		// time between two walk requests (ms, 0 = don't walk)
+	int64_t speechInterval;		// time between two sentences (ms, 0 = don't talk)
+	int64_t combatInterval;		// time between two attack requests (ms, 0 = don't fight)
+};
+
+struct LatencySamples
+{
+	std::vector<uint32_t> samples;	// round trip times (us)
+	uint64_t sent;
+	uint64_t answered;
+	uint64_t rejected;
+
+	LatencySamples() : sent(0), answered(0), rejected(0) { }
+	void add(int64_t latency) { samples.push_back((uint32_t)latency); ++answered; }
+};
+
+struct Stats
+{
+	LatencySamples moves;	// walk request -> ack/reject
+	LatencySamples speech;	// speech -> own speech echoed back
+	uint64_t attacks;		// attack requests sent
+	uint64_t bytesSent;
+	uint64_t bytesReceived;
+	uint64_t packetsReceived;
+	uint64_t loginFailures;
+
+	Stats() : attacks(0), bytesSent(0), bytesReceived(0), packetsReceived(0), loginFailures(0) { }
+};
+
+/***************************************************************************
+ *
+ *
+ *	class HeadlessClient		One bot connection
+ *
+ *	Goes through the same steps as a real client: seed and account login on
+ *	the login server, relay to the game server, character selection (or
+ *	creation for new accounts), then walks, talks and attacks the other
+ *	mobiles it sees at the configured rates. The traffic is encrypted with
+ *	the keys of the reported client version, by the server's own CCrypto.
+ *
+ ***************************************************************************/
+class HeadlessClient
+{
+public:
+	enum State
+	{
+		STATE_IDLE,
+		STATE_LOGIN,		// connected to the login server
+		STATE_RELAY,		// server selected, waiting to be relayed
+		STATE_GAMELOGIN,	// connected to the game server
+		STATE_CHARLIST,		// waiting for the character list
+		STATE_ENTERING,		// character selected, waiting for the world
+		STATE_INWORLD,
+		STATE_CLOSED
+	};
+
+private:
+	const Settings& m_settings;
+	Stats& m_stats;
+	uint32_t m_index;
+	State m_state;
+	Socket m_socket;
+	ByteBuffer m_input;			// received data not processed yet (login server)
+	HuffmanDecoder m_decoder;
+	CCrypto m_crypt;
+	uint32_t m_relayKey;
+	uint16_t m_relayPort;
+
+	uint32_t m_serial;			// own character
+	uint8_t m_direction;
+	uint8_t m_sequence;			// next walk sequence
+	int64_t m_moveSent;			// time the pending walk request has been sent (us, 0 = none pending)
+	int64_t m_nextMove;			// time of the next walk request (ms)
+	int64_t m_speechSent;		// time the pending sentence has been sent (us, 0 = none pending)
+	uint32_t m_speechCount;
+	int64_t m_nextSpeech;		// time of the next sentence (ms)
+	int64_t m_nextAttack;		// time of the next attack request (ms)
+	bool m_warMode;
+	std::vector<uint32_t> m_mobiles;	// other mobiles in view
+	uint32_t m_random;
+
+public:
+	HeadlessClient(const Settings& settings, Stats& stats, uint32_t index);
+
+private:
+	HeadlessClient(const HeadlessClient& copy);
+	HeadlessClient& operator=(const HeadlessClient& other);
+
+public:
+	bool start(int64_t now);		// connect to the login server
+	void close(void);
+	void onReadable(int64_t now);	// data can be received
+	void onWritable(int64_t now);	// data can be sent
+	void tick(int64_t now);			// send the periodic requests
+
+	State getState(void) const { return m_state; }
+	Socket& getSocket(void) { return m_socket; }
+
+private:
+	void send(const PacketWriter& packet);	// encrypted
+	void sendRaw(const uint8_t* data, size_t length);
+	bool initCrypt(uint32_t seed, CONNECT_TYPE type);
+	void onConnected(void);
+	void onLoginPacket(const uint8_t* data, size_t length);
+	void onGamePacket(const uint8_t* data, size_t length, int64_t now);
+	void onCharList(PacketReader& reader);
+	void onEnterWorld(int64_t now);
+	void sendWalk(int64_t now);
+	void sendSpeech(int64_t now);
+	void sendAttack(void);
+	void addMobile(uint32_t serial);
+	void removeMobile(uint32_t serial);
+	uint32_t random(void);
+	std::string getAccountName(void) const;
+};
+
+} // namespace headless
+
+#endif // _INC_HEADLESSCLIENT_H
@@ -0,0 +1,450 @@
+/**
+* @file HeadlessDriver.cpp
+* @brief Spawns headless clients against a server and reports what they observe.
+*
+* Usage: sphereheadless [options]
+*   -h <host>          server address (127.0.0.1)
+*   -p <port>          login server port (2593)
+*   -n <count>         number of bots (100)
+*   -r <rate>          bots connecting per second (50)
+*   -a <prefix>        account name prefix, bots use <prefix><index> (bot)
+*   -w <password>      account password (bot)
+*   -v <a.b.c.d>       reported client version (7.0.15.1)
+*   -k <file>          client encryption keys (sphereCrypt.ini), "none" = don't
+*                      encrypt (the server must allow it with UseNoCrypt=1)
+*   -m <ms>            time between walk requests per bot, 0 = no walking (400)
+*   -s <ms>            time between sentences per bot, 0 = no speech (10000)
+*   -c <ms>            time between attack requests per bot, 0 = no combat (0)
+*   -t <seconds>       test duration, 0 = until interrupted (60)
+*   -i <seconds>       report interval (10)
+*   -A <account>       admin account for the telnet console, used to print the
+*   -P <password>      server profile (tick times) at every report
+*
+* The bots encrypt their traffic like the reported client version, with the
+* keys of the server's sphereCrypt.ini. The server must either create
+* accounts on the fly (AccApp) or have the bot accounts already.
+*/
+
+#include "HeadlessClient.h"
+#include <algorithm>
+#include <cctype>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#define HEADLESS_POLL	WSAPoll
+#else
+	#define HEADLESS_POLL	poll
+#endif
+
+
+namespace
+{
+	volatile sig_atomic_t s_stop = 0;
+
+	void OnSignal(int)
+	{
+		s_stop = 1;
+	}
+
+	/***************************************************************************
+	 *
+	 *
+	 *	class AdminConsole			Telnet session printing the server profile
+	 *
+	 *
+	 ***************************************************************************/
+	class AdminConsole
+	{
+	private:
+		headless::Socket m_socket;
+		std::string m_account;
+		std::string m_password;
+		int m_step;				// 0 = connecting, 1 = waiting for the welcome, 2 = logged in
+		std::string m_line;		// incomplete line received
+
+	public:
+		AdminConsole(void) : m_step(0) { }
+
+	public:
+		bool start(const std::string& host, uint16_t port, const std::string& account, const std::string& password)
+		{
+			m_account = account;
+			m_password = password;
+			m_step = 0;
+			return m_socket.connect(host, port);
+		}
+
+		void onWritable(void)
+		{
+			if (m_socket.isConnecting())
+			{
+				if (!m_socket.finishConnect())
+				{
+					fprintf(stderr, "Admin console: connection failed.\n");
+					m_socket.close();
+					return;
+				}
+
+				// a lone space asks for the remote admin console
+				sendText(" \r\n");
+				m_step = 1;
+			}
+			m_socket.flush();
+		}
+
+		void onReadable(void)
+		{
+			char buffer[4096];
+			for (;;)
+			{
+				const int received = m_socket.receive(reinterpret_cast<uint8_t*>(buffer), sizeof(buffer));
+				if (received == 0)
+					return;
+				if (received < 0)
+				{
+					fprintf(stderr, "Admin console: connection closed.\n");
+					m_socket.close();
+					return;
+				}
+
+				if (m_step == 1)
+				{
+					// the welcome must arrive before the login, the request has to be in a packet on its own
+					sendText(m_account + "\r\n" + m_password + "\r\n");
+					m_step = 2;
+				}
+
+				for (int i = 0; i < received; ++i)
+				{
+					if (buffer[i] == '\r')
+						continue;
+					if (buffer[i] != '\n')
+					{
+						m_line.push_back(buffer[i]);
+						continue;
+					}
+					if (!m_line.empty())
+						printf("[server] %s\n", m_line.c_str());
+					m_line.clear();
+				}
+			}
+		}
+
+		void requestProfile(void)
+		{
+			if (m_step == 2)
+				sendText("p\r\n");
+		}
+
+		headless::Socket& getSocket(void) { return m_socket; }
+
+	private:
+		void sendText(const std::string& text)
+		{
+			m_socket.send(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		}
+	};
+
+	uint32_t GetPercentile(std::vector<uint32_t>& samples, double percentile)
+	{
+		if (samples.empty())
+			return 0;
+		const size_t index = std::min(samples.size() - 1, (size_t)(percentile * (double)(samples.size() - 1) + 0.5));
+		std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+		return samples[index];
+	}
+
+	void PrintLatency(const char* name, headless::LatencySamples& latency)
+	{
+		std::vector<uint32_t>& samples = latency.samples;
+		const uint32_t p50 = GetPercentile(samples, 0.50);
+		const uint32_t p95 = GetPercentile(samples, 0.95);
+		const uint32_t p99 = GetPercentile(samples, 0.99);
+		const uint32_t max = samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+
+		printf("  %-7s sent=%llu answered=%llu rejected=%llu  latency ms p50=%.1f p95=%.1f p99=%.1f max=%.1f\n", name,
+			(unsigned long long)latency.sent, (unsigned long long)latency.answered, (unsigned long long)latency.rejected,
+			p50 / 1000.0, p95 / 1000.0, p99 / 1000.0, max / 1000.0);
+
+		latency = headless::LatencySamples();
+	}
+
+	uint32_t ParseKeyNumber(const char* text)
+	{
+		// Sphere numbers: starting with 0 = hexadecimal, like ahextoi
+		return (uint32_t)strtoul(text, nullptr, (text[0] == '0') ? 16 : 10);
+	}
+
+	bool ParseEncryptionType(const char* text, ENCRYPTION_TYPE& type)
+	{
+		static const char* const sm_names[ENC_QTY] = { "ENC_NONE", "ENC_BFISH", "ENC_BTFISH", "ENC_TFISH", "ENC_LOGIN" };
+		for (int i = 0; i < ENC_QTY; ++i)
+		{
+			if (strcmp(text, sm_names[i]) == 0)
+			{
+				type = (ENCRYPTION_TYPE)i;
+				return true;
+			}
+		}
+		if (text[0] < '0' || text[0] > '9' || ParseKeyNumber(text) >= ENC_QTY)
+			return false;
+		type = (ENCRYPTION_TYPE)ParseKeyNumber(text);
+		return true;
+	}
+
+	bool LoadClientKeys(const char* path)
+	{
+		// same table the server loads with CCrypto::LoadKeyTable: <client version> <key 1> <key 2> <encryption type>
+		FILE* file = fopen(path, "r");
+		if (file == nullptr)
+			return false;
+
+		CCrypto::client_keys.clear();
+		CCrypto::addNoCryptKey();
+
+		bool inSection = false;
+		char line[256];
+		while (fgets(line, sizeof(line), file) != nullptr)
+		{
+			char* comment = strstr(line, "//");
+			if (comment != nullptr)
+				*comment = '\0';
+
+			const char* version = strtok(line, " \t\r\n");
+			if (version == nullptr)
+				continue;
+			if (version[0] == '[')
+			{
+				std::string section(version);
+				std::transform(section.begin(), section.end(), section.begin(), [](char c) { return (char)toupper((unsigned char)c); });
+				inSection = (section == "[SPHERECRYPT]");
+				continue;
+			}
+
+			const char* key1 = strtok(nullptr, " \t\r\n");
+			const char* key2 = strtok(nullptr, " \t\r\n");
+			const char* type = strtok(nullptr, " \t\r\n");
+			CCryptoClientKey key;
+			if (!inSection || type == nullptr || !ParseEncryptionType(type, key.m_EncType))
+				continue;
+
+			key.m_client = ParseKeyNumber(version);
+			key.m_key_1 = ParseKeyNumber(key1);
+			key.m_key_2 = ParseKeyNumber(key2);
+			CCrypto::client_keys.push_back(key);
+		}
+
+		fclose(file);
+		return (CCrypto::client_keys.size() > 1);
+	}
+
+	void PrintUsage(void)
+	{
+		printf("Usage: sphereheadless [-h host] [-p port] [-n bots] [-r bots/s] [-a account prefix] [-w password] [-v version] [-k keys]\n"
+			"                      [-m walk ms] [-s speech ms] [-c attack ms] [-t seconds] [-i report seconds]\n"
+			"                      [-A admin account -P admin password]\n");
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	headless::Settings settings;
+	settings.host = "127.0.0.1";
+	settings.port = 2593;
+	settings.accountPrefix = "bot";
+	settings.password = "bot";
+	settings.version[0] = 7;
+	settings.version[1] = 0;
+	settings.version[2] = 15;
+	settings.version[3] = 1;
+	settings.encrypt = true;
+	settings.moveInterval = 400;
+	settings.speechInterval = 10000;
+	settings.combatInterval = 0;
+
+	uint32_t botCount = 100;
+	uint32_t connectRate = 50;
+	int64_t duration = 60;
+	int64_t reportInterval = 10;
+	std::string adminAccount, adminPassword;
+	std::string keysFile = "sphereCrypt.ini";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || (i + 1) >= argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		const char* value = argv[++i];
+		switch (argv[i - 1][1])
+		{
+			case 'h': settings.host = value; break;
+			case 'p': settings.port = (uint16_t)atoi(value); break;
+			case 'n': botCount = (uint32_t)atoi(value); break;
+			case 'r': connectRate = (uint32_t)std::max(1, atoi(value)); break;
+			case 'a': settings.accountPrefix = value; break;
+			case 'w': settings.password = value; break;
+			case 'v':
+				if (sscanf(value, "%u.%u.%u.%u", &settings.version[0], &settings.version[1], &settings.version[2], &settings.version[3]) != 4)
+				{
+					PrintUsage();
+					return 1;
+				}
+				break;
+			case 'k': keysFile = value; break;
+			case 'm': settings.moveInterval = atoll(value); break;
+			case 's': settings.speechInterval = atoll(value); break;
+			case 'c': settings.combatInterval = atoll(value); break;
+			case 't': duration = atoll(value); break;
+			case 'i': reportInterval = std::max(1LL, atoll(value)); break;
+			case 'A': adminAccount = value; break;
+			case 'P': adminPassword = value; break;
+			default:
+				PrintUsage();
+				return 1;
+		}
+	}
+
+	settings.encrypt = (keysFile != "none");
+	if (settings.encrypt && !LoadClientKeys(keysFile.c_str()))
+	{
+		fprintf(stderr, "Can't load the client encryption keys from %s (use -k).\n", keysFile.c_str());
+		return 1;
+	}
+
+	if (!headless::Socket::startup())
+	{
+		fprintf(stderr, "Socket library initialisation failed.\n");
+		return 1;
+	}
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	headless::Stats stats;
+	std::vector<std::unique_ptr<headless::HeadlessClient>> clients;
+	clients.reserve(botCount);
+	for (uint32_t i = 0; i < botCount; ++i)
+		clients.emplace_back(new headless::HeadlessClient(settings, stats, i));
+
+	AdminConsole console;
+	const bool useConsole = !adminAccount.empty();
+	if (useConsole && !console.start(settings.host, settings.port, adminAccount, adminPassword))
+		fprintf(stderr, "Admin console: can't connect.\n");
+
+	printf("Starting %u bots against %s:%u (%u/s).\n", botCount, settings.host.c_str(), (unsigned)settings.port, connectRate);
+
+	const int64_t startTime = headless::GetTimeMicro();
+	int64_t nextReport = startTime + (reportInterval * 1000000);
+	uint32_t started = 0;
+
+	std::vector<pollfd> fds;
+	std::vector<headless::HeadlessClient*> polled;
+	while (s_stop == 0)
+	{
+		const int64_t now = headless::GetTimeMicro();
+		if (duration > 0 && (now - startTime) >= (duration * 1000000))
+			break;
+
+		// connect the bots progressively, a login storm would only measure the accept queue
+		const uint32_t due = (uint32_t)std::min<int64_t>(botCount, ((now - startTime) * connectRate / 1000000) + 1);
+		for (; started < due; ++started)
+			clients[started]->start(now);
+
+		fds.clear();
+		polled.clear();
+		for (uint32_t i = 0; i < started; ++i)
+		{
+			headless::HeadlessClient* client = clients[i].get();
+			client->tick(now);
+			if (!client->getSocket().isOpen())
+				continue;
+
+			pollfd fd;
+			fd.fd = client->getSocket().getHandle();
+			fd.events = POLLIN | (client->getSocket().wantsWrite() ? POLLOUT : 0);
+			fd.revents = 0;
+			fds.push_back(fd);
+			polled.push_back(client);
+		}
+
+		if (useConsole && console.getSocket().isOpen())
+		{
+			pollfd fd;
+			fd.fd = console.getSocket().getHandle();
+			fd.events = POLLIN | (console.getSocket().wantsWrite() ? POLLOUT : 0);
+			fd.revents = 0;
+			fds.push_back(fd);
+			polled.push_back(nullptr);
+		}
+
+		if (fds.empty() || HEADLESS_POLL(fds.data(), (unsigned long)fds.size(), 5) <= 0)
+		{
+			if (fds.empty() && started >= botCount)
+				break;	// every bot is gone
+		}
+		else
+		{
+			const int64_t eventTime = headless::GetTimeMicro();
+			for (size_t i = 0; i < fds.size(); ++i)
+			{
+				if (fds[i].revents == 0)
+					continue;
+
+				headless::HeadlessClient* client = polled[i];
+				if (client == nullptr)
+				{
+					if (fds[i].revents & POLLOUT)
+						console.onWritable();
+					if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+						console.onReadable();
+					continue;
+				}
+
+				if (fds[i].revents & (POLLOUT | POLLERR))
+					client->onWritable(eventTime);
+				if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && client->getSocket().isOpen() && !client->getSocket().isConnecting())
+					client->onReadable(eventTime);
+			}
+		}
+
+		if (now < nextReport)
+			continue;
+
+		nextReport += reportInterval * 1000000;
+
+		uint32_t states[headless::HeadlessClient::STATE_CLOSED + 1] = {};
+		for (uint32_t i = 0; i < started; ++i)
+			++states[clients[i]->getState()];
+
+		printf("[%llds] bots: connecting=%u in world=%u closed=%u  login failures=%llu  traffic: sent=%llu KB received=%llu KB (%llu packets)\n",
+			(long long)((now - startTime) / 1000000),
+			states[headless::HeadlessClient::STATE_LOGIN] + states[headless::HeadlessClient::STATE_RELAY] + states[headless::HeadlessClient::STATE_GAMELOGIN] +
+				states[headless::HeadlessClient::STATE_CHARLIST] + states[headless::HeadlessClient::STATE_ENTERING],
+			states[headless::HeadlessClient::STATE_INWORLD], states[headless::HeadlessClient::STATE_CLOSED],
+			(unsigned long long)stats.loginFailures, (unsigned long long)(stats.bytesSent / 1024), (unsigned long long)(stats.bytesReceived / 1024),
+			(unsigned long long)stats.packetsReceived);
+		PrintLatency("walk", stats.moves);
+		PrintLatency("speech", stats.speech);
+		if (settings.combatInterval > 0)
+			printf("  attacks sent=%llu\n", (unsigned long long)stats.attacks);
+		fflush(stdout);
+
+		if (useConsole)
+			console.requestProfile();
+	}
+
+	printf("Stopping.\n");
+	clients.clear();
+	headless::Socket::cleanup();
+	return 0;
+}
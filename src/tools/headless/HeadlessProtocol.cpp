@@ -0,0 +1,233 @@
+#include "HeadlessProtocol.h"
+#include "../../common/crypto/CCrypto.h"
+#include "../../network/send.h"
+#include <cstring>
+
+
+namespace headless
+{
+
+namespace
+{
+	// Lengths of the packets sent by the server (send.h), 0 = variable length
+	const size_t sm_LoginPacketLengths[][2] =
+	{
+		{ XCMD_IdleWarning,	PacketWarningMessage::kuiLength },	// login error (old)
+		{ XCMD_LogBad,		PacketLoginError::kuiLength },
+		{ XCMD_CharList2,	0 },								// character list update
+		{ XCMD_Relay,		PacketServerRelay::kuiLength },		// relay to game server
+		{ XCMD_ServerList,	0 },
+		{ XCMD_CharList,	0 },
+	};
+}
+
+
+/***************************************************************************
+ *
+ *
+ *	class PacketWriter			Builds a client->server packet
+ *
+ *
+ ***************************************************************************/
+PacketWriter::PacketWriter(uint8_t id, size_t expectedLength) : m_expectedLength(expectedLength)
+{
+	m_data.reserve((expectedLength > 0) ? expectedLength : 128);
+	m_data.push_back(id);
+}
+
+void PacketWriter::writeByte(uint8_t value)
+{
+	m_data.push_back(value);
+}
+
+void PacketWriter::writeInt16(uint16_t value)
+{
+	m_data.push_back((uint8_t)(value >> 8));
+	m_data.push_back((uint8_t)(value));
+}
+
+void PacketWriter::writeInt32(uint32_t value)
+{
+	m_data.push_back((uint8_t)(value >> 24));
+	m_data.push_back((uint8_t)(value >> 16));
+	m_data.push_back((uint8_t)(value >> 8));
+	m_data.push_back((uint8_t)(value));
+}
+
+void PacketWriter::writeString(const std::string& value, size_t length)
+{
+	for (size_t i = 0; i < length; ++i)
+		m_data.push_back((i < value.size()) ? (uint8_t)value[i] : 0);
+}
+
+void PacketWriter::writeStringNull(const std::string& value)
+{
+	m_data.insert(m_data.end(), value.begin(), value.end());
+	m_data.push_back(0);
+}
+
+void PacketWriter::fill(size_t length)
+{
+	m_data.insert(m_data.end(), length, 0);
+}
+
+void PacketWriter::finaliseLength(void)
+{
+	const size_t length = m_data.size();
+	m_data[1] = (uint8_t)(length >> 8);
+	m_data[2] = (uint8_t)(length);
+}
+
+bool PacketWriter::isComplete(void) const
+{
+	if (m_expectedLength > 0)
+		return (m_data.size() == m_expectedLength);
+	return (m_data.size() >= 3) && (((size_t)(m_data[1] << 8) | m_data[2]) == m_data.size());
+}
+
+
+/***************************************************************************
+ *
+ *
+ *	class PacketReader			Reads a server->client packet
+ *
+ *
+ ***************************************************************************/
+uint8_t PacketReader::readByte(void)
+{
+	if (m_position >= m_length)
+		return 0;
+	return m_data[m_position++];
+}
+
+uint16_t PacketReader::readInt16(void)
+{
+	const uint16_t high = readByte();
+	return (uint16_t)((high << 8) | readByte());
+}
+
+uint32_t PacketReader::readInt32(void)
+{
+	const uint32_t high = readInt16();
+	return (high << 16) | readInt16();
+}
+
+std::string PacketReader::readString(size_t length)
+{
+	std::string value;
+	for (size_t i = 0; i < length && m_position < m_length; ++i)
+	{
+		const char c = (char)m_data[m_position++];
+		if (c == '\0')
+		{
+			m_position += (length - i - 1);
+			break;
+		}
+		value.push_back(c);
+	}
+	return value;
+}
+
+
+/***************************************************************************
+ *
+ *
+ *	class HuffmanDecoder		Server->client decompression
+ *
+ *
+ ***************************************************************************/
+std::vector<HuffmanDecoder::Node> HuffmanDecoder::sm_tree;
+
+HuffmanDecoder::HuffmanDecoder(void) : m_node(0)
+{
+	if (sm_tree.empty())
+		buildTree();
+}
+
+void HuffmanDecoder::buildTree(void)
+{
+	// insert every code in a binary tree, walking it bit by bit gives back the symbol
+	Node root;
+	root.child[0] = root.child[1] = 0;
+	sm_tree.push_back(root);
+
+	const word* codes = CHuffman::GetCodes();
+	for (int symbol = 0; symbol < COMPRESS_TREE_SIZE; ++symbol)
+	{
+		const uint16_t value = codes[symbol];
+		const int bits = value & 0xF;
+		const int code = value >> 4;
+
+		int node = 0;
+		for (int i = bits - 1; i >= 0; --i)
+		{
+			const int bit = (code >> i) & 0x1;
+			if (i == 0)
+			{
+				sm_tree[node].child[bit] = (int16_t)~symbol;
+				break;
+			}
+
+			if (sm_tree[node].child[bit] <= 0)
+			{
+				Node child;
+				child.child[0] = child.child[1] = 0;
+				sm_tree.push_back(child);
+				sm_tree[node].child[bit] = (int16_t)(sm_tree.size() - 1);
+			}
+			node = sm_tree[node].child[bit];
+		}
+	}
+}
+
+void HuffmanDecoder::decode(const uint8_t* data, size_t length, std::vector<ByteBuffer>& packets)
+{
+	for (size_t i = 0; i < length; ++i)
+	{
+		const uint8_t value = data[i];
+		for (int bit = 7; bit >= 0; --bit)
+		{
+			const int16_t next = sm_tree[m_node].child[(value >> bit) & 0x1];
+			if (next > 0)
+			{
+				m_node = next;
+				continue;
+			}
+
+			m_node = 0;
+			const int symbol = ~next;
+			if (symbol < 256)
+			{
+				m_packet.push_back((uint8_t)symbol);
+				continue;
+			}
+
+			// end of packet, the rest of this byte is padding
+			packets.push_back(m_packet);
+			m_packet.clear();
+			break;
+		}
+	}
+}
+
+void HuffmanDecoder::reset(void)
+{
+	m_node = 0;
+	m_packet.clear();
+}
+
+
+bool GetLoginPacketLength(uint8_t id, size_t& length)
+{
+	for (size_t i = 0; i < (sizeof(sm_LoginPacketLengths) / sizeof(sm_LoginPacketLengths[0])); ++i)
+	{
+		if (sm_LoginPacketLengths[i][0] != id)
+			continue;
+
+		length = sm_LoginPacketLengths[i][1];
+		return true;
+	}
+	return false;
+}
+
+} // namespace headless
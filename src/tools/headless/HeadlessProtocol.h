@@ -0,0 +1,115 @@
+/**
+* @file HeadlessProtocol.h
+* @brief Packet building and Huffman decompression for the headless client simulator.
+*/
+
+#ifndef _INC_HEADLESSPROTOCOL_H
+#define _INC_HEADLESSPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace headless
+{
+
+typedef std::vector<uint8_t> ByteBuffer;
+
+/***************************************************************************
+ *
+ *
+ *	class PacketWriter			Builds a client->server packet
+ *
+ *
+ ***************************************************************************/
+class PacketWriter
+{
+private:
+	ByteBuffer m_data;
+	size_t m_expectedLength;
+
+public:
+	PacketWriter(uint8_t id, size_t expectedLength);	// expected length of the packet, as the server reads it (receive.h), 0 = variable length
+
+public:
+	void writeByte(uint8_t value);
+	void writeInt16(uint16_t value);
+	void writeInt32(uint32_t value);
+	void writeString(const std::string& value, size_t length);	// fixed length, zero padded
+	void writeStringNull(const std::string& value);				// zero terminated
+	void fill(size_t length);										// zero bytes
+	void finaliseLength(void);										// write the length of a variable sized packet at offset 1
+	bool isComplete(void) const;									// all the fields of the packet have been written
+
+	const ByteBuffer& getData(void) const { return m_data; }
+};
+
+/***************************************************************************
+ *
+ *
+ *	class PacketReader			Reads a server->client packet
+ *
+ *
+ ***************************************************************************/
+class PacketReader
+{
+private:
+	const uint8_t* m_data;
+	size_t m_length;
+	size_t m_position;
+
+public:
+	PacketReader(const uint8_t* data, size_t length) : m_data(data), m_length(length), m_position(0) { }
+
+public:
+	uint8_t readByte(void);
+	uint16_t readInt16(void);
+	uint32_t readInt32(void);
+	std::string readString(size_t length);
+	void skip(size_t length) { m_position += length; }
+	void seek(size_t position) { m_position = position; }
+	size_t getRemainingLength(void) const { return (m_position < m_length) ? (m_length - m_position) : 0; }
+};
+
+/***************************************************************************
+ *
+ *
+ *	class HuffmanDecoder		Server->client decompression
+ *
+ *	The server compresses every packet on its own (CHuffman::Compress) and
+ *	terminates it with a special code padded to a byte boundary, so the
+ *	decoder also splits the stream into packets without needing to know
+ *	their lengths. The codes are the ones of CHuffman.
+ *
+ ***************************************************************************/
+class HuffmanDecoder
+{
+private:
+	struct Node
+	{
+		int16_t child[2];	// >= 0: next node, < 0: leaf holding ~symbol
+	};
+
+	static std::vector<Node> sm_tree;
+	int m_node;				// current position in the tree
+	ByteBuffer m_packet;	// packet being decoded
+
+public:
+	HuffmanDecoder(void);
+
+public:
+	void decode(const uint8_t* data, size_t length, std::vector<ByteBuffer>& packets);	// decode data, completed packets are appended to packets
+	void reset(void);
+
+private:
+	static void buildTree(void);
+};
+
+// Length of the packets received before compression starts (login server), 0 = variable length
+bool GetLoginPacketLength(uint8_t id, size_t& length);
+
+} // namespace headless
+
+#endif // _INC_HEADLESSPROTOCOL_H
@@ -0,0 +1,177 @@
+#include "HeadlessSocket.h"
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+	#include <arpa/inet.h>
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+#endif
+
+
+namespace headless
+{
+
+namespace
+{
+	bool IsWouldBlock(void)
+	{
+#ifdef _WIN32
+		const int error = WSAGetLastError();
+		return (error == WSAEWOULDBLOCK) || (error == WSAEINPROGRESS);
+#else
+		return (errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINPROGRESS) || (errno == EINTR);
+#endif
+	}
+}
+
+
+/***************************************************************************
+ *
+ *
+ *	class Socket				Non blocking TCP connection
+ *
+ *
+ ***************************************************************************/
+Socket::Socket(void) : m_socket(HEADLESS_INVALID_SOCKET), m_connecting(false)
+{
+}
+
+Socket::~Socket(void)
+{
+	close();
+}
+
+bool Socket::startup(void)
+{
+#ifdef _WIN32
+	WSADATA wsaData;
+	return (WSAStartup(MAKEWORD(2, 2), &wsaData) == 0);
+#else
+	return true;
+#endif
+}
+
+void Socket::cleanup(void)
+{
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+bool Socket::connect(const std::string& host, uint16_t port)
+{
+	close();
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* result = nullptr;
+	if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr)
+		return false;
+
+	sockaddr_in address;
+	memcpy(&address, result->ai_addr, sizeof(address));
+	address.sin_port = htons(port);
+	freeaddrinfo(result);
+
+	m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (m_socket == HEADLESS_INVALID_SOCKET)
+		return false;
+
+	// the server sends small packets, waiting to coalesce them would only add latency
+	int noDelay = 1;
+	setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket(m_socket, FIONBIO, &nonBlocking);
+#else
+	fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+	if (::connect(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		if (!IsWouldBlock())
+		{
+			close();
+			return false;
+		}
+	}
+
+	m_connecting = true;
+	return true;
+}
+
+bool Socket::finishConnect(void)
+{
+	m_connecting = false;
+
+	int error = 0;
+	socklen_t length = sizeof(error);
+	if (getsockopt(m_socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) != 0 || error != 0)
+		return false;
+
+	return true;
+}
+
+void Socket::close(void)
+{
+	if (m_socket != HEADLESS_INVALID_SOCKET)
+	{
+#ifdef _WIN32
+		closesocket(m_socket);
+#else
+		::close(m_socket);
+#endif
+		m_socket = HEADLESS_INVALID_SOCKET;
+	}
+	m_connecting = false;
+	m_output.clear();
+}
+
+bool Socket::send(const uint8_t* data, size_t length)
+{
+	m_output.insert(m_output.end(), data, data + length);
+	if (m_connecting)
+		return true;
+	return flush();
+}
+
+bool Socket::flush(void)
+{
+	while (!m_output.empty())
+	{
+		const int sent = (int)::send(m_socket, reinterpret_cast<const char*>(m_output.data()), (int)m_output.size(), 0);
+		if (sent <= 0)
+			return IsWouldBlock();
+
+		m_output.erase(m_output.begin(), m_output.begin() + sent);
+	}
+	return true;
+}
+
+int Socket::receive(uint8_t* buffer, size_t length)
+{
+	const int received = (int)::recv(m_socket, reinterpret_cast<char*>(buffer), (int)length, 0);
+	if (received > 0)
+		return received;
+	if (received < 0 && IsWouldBlock())
+		return 0;
+	return -1;
+}
+
+
+int64_t GetTimeMicro(void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace headless
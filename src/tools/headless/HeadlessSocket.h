@@ -0,0 +1,75 @@
+/**
+* @file HeadlessSocket.h
+* @brief Minimal non blocking TCP socket for the headless client simulator.
+*/
+
+#ifndef _INC_HEADLESSSOCKET_H
+#define _INC_HEADLESSSOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	typedef SOCKET socket_t;
+	#define HEADLESS_INVALID_SOCKET	INVALID_SOCKET
+#else
+	#include <poll.h>
+	typedef int socket_t;
+	#define HEADLESS_INVALID_SOCKET	(-1)
+#endif
+
+
+namespace headless
+{
+
+/***************************************************************************
+ *
+ *
+ *	class Socket				Non blocking TCP connection
+ *
+ *	Data that can't be sent right away is kept and sent again once the
+ *	socket is writable (see wantsWrite).
+ *
+ ***************************************************************************/
+class Socket
+{
+private:
+	socket_t m_socket;
+	bool m_connecting;				// connect() still in progress
+	std::vector<uint8_t> m_output;	// data waiting to be sent
+
+public:
+	Socket(void);
+	~Socket(void);
+
+private:
+	Socket(const Socket& copy);
+	Socket& operator=(const Socket& other);
+
+public:
+	static bool startup(void);	// initialise the socket library
+	static void cleanup(void);
+
+	bool connect(const std::string& host, uint16_t port);	// start connecting
+	bool finishConnect(void);	// check the result of connect() once writable
+	void close(void);
+
+	bool send(const uint8_t* data, size_t length);	// send or queue data, false on error
+	bool flush(void);								// send queued data, false on error
+	int receive(uint8_t* buffer, size_t length);	// > 0: received bytes, 0: nothing to read, < 0: closed/error
+
+	bool isOpen(void) const { return m_socket != HEADLESS_INVALID_SOCKET; }
+	bool isConnecting(void) const { return m_connecting; }
+	bool wantsWrite(void) const { return m_connecting || !m_output.empty(); }
+	socket_t getHandle(void) const { return m_socket; }
+};
+
+int64_t GetTimeMicro(void);	// monotonic time (us)
+
+} // namespace headless
+
+#endif // _INC_HEADLESSSOCKET_H
@@ -0,0 +1,148 @@
+// Stress test of ThreadSafeQueue (src/sphere/containers.h): several writer threads and a single reader.
+// The ring is kept small so that it fills up and the elements spill to the overflow list, and the reader
+//  takes part of the elements with front() before removing them with pop(), as CNetworkOutput does.
+// It checks that no element is lost or duplicated and that the elements of each writer keep their order.
+// Exit code 0 = passed.
+
+#include "../src/sphere/containers.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// The queue only needs CSError to report reading an empty queue: no need for the whole exception handling of the server.
+CSError::CSError( LOG_TYPE eSev, dword hErr, lpctstr pszDescription ) :
+	m_eSeverity( eSev ), m_hError( hErr ), m_pszDescription( pszDescription )
+{
+}
+CSError::CSError( const CSError &e ) :
+	m_eSeverity( e.m_eSeverity ), m_hError( e.m_hError ), m_pszDescription( e.m_pszDescription )
+{
+}
+bool CSError::GetErrorMessage( lptstr lpszError, uint uiMaxError ) const
+{
+	snprintf( lpszError, uiMaxError, "%s", m_pszDescription );
+	return true;
+}
+
+
+static constexpr uint kuiWriters = 4;
+static constexpr uint kuiElementsPerWriter = 200000;
+
+struct Element
+{
+	uint m_uiWriter;
+	uint m_uiSeq;		// 1-based, 0 = default constructed
+};
+
+static int Fail( const char * pszWhat, uint uiWriter, uint uiSeq )
+{
+	fprintf( stderr, "ThreadSafeQueue: %s (writer %u, element %u)\n", pszWhat, uiWriter, uiSeq );
+	return 1;
+}
+
+static bool TestEmptyQueue()
+{
+	ThreadSafeQueue<Element, 4> queue;
+	if ( !queue.empty() || (queue.size() != 0) )
+		return false;
+
+	bool fThrown = false;
+	try
+	{
+		queue.pop();
+	}
+	catch ( const CSError & )
+	{
+		fThrown = true;
+	}
+	return fThrown;
+}
+
+static int TestWriters()
+{
+	ThreadSafeQueue<Element, 8> queue;
+	std::atomic<uint> uiWritersDone( 0 );
+
+	std::vector<std::thread> vWriters;
+	for ( uint uiWriter = 0; uiWriter < kuiWriters; ++uiWriter )
+	{
+		vWriters.emplace_back( [&queue, &uiWritersDone, uiWriter]()
+		{
+			for ( uint uiSeq = 1; uiSeq <= kuiElementsPerWriter; ++uiSeq )
+			{
+				queue.push( Element{ uiWriter, uiSeq } );
+				if ( (uiSeq % 4096) == 0 )
+					std::this_thread::yield();
+			}
+			uiWritersDone.fetch_add( 1 );
+		} );
+	}
+
+	std::vector<uint> vLastSeq( kuiWriters, 0 );
+	uint uiRead = 0;
+	uint uiRound = 0;
+	const uint uiTotal = kuiWriters * kuiElementsPerWriter;
+	while ( uiRead < uiTotal )
+	{
+		if ( queue.empty() )
+		{
+			if ( (uiWritersDone.load() == kuiWriters) && queue.empty() )
+				return Fail( "elements lost", 0, uiRead );
+			std::this_thread::yield();
+			continue;
+		}
+
+		++uiRound;
+		if ( (uiRound % 1024) == 0 )
+			std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );	// let the writers fill the ring and overflow
+
+		Element element;
+		if ( (uiRound % 3) == 0 )
+		{
+			// take the element with front() first: it must stay in the queue, and front() must give it again, until pop()
+			element = queue.front();
+			if ( queue.empty() || (queue.size() == 0) )
+				return Fail( "element taken by front() not counted", element.m_uiWriter, element.m_uiSeq );
+			const Element again = queue.front();
+			if ( (again.m_uiWriter != element.m_uiWriter) || (again.m_uiSeq != element.m_uiSeq) )
+				return Fail( "front() changed before pop()", element.m_uiWriter, element.m_uiSeq );
+			queue.pop();
+		}
+		else
+		{
+			element = queue.front();
+			queue.pop();
+		}
+
+		if ( (element.m_uiWriter >= kuiWriters) || (element.m_uiSeq == 0) )
+			return Fail( "bad element", element.m_uiWriter, element.m_uiSeq );
+		if ( element.m_uiSeq != vLastSeq[element.m_uiWriter] + 1 )
+			return Fail( "element out of order, lost or duplicated", element.m_uiWriter, element.m_uiSeq );
+		vLastSeq[element.m_uiWriter] = element.m_uiSeq;
+		++uiRead;
+	}
+
+	for ( std::thread & writer : vWriters )
+		writer.join();
+
+	if ( !queue.empty() || (queue.size() != 0) )
+		return Fail( "elements left after reading all of them", 0, uiRead );
+	return 0;
+}
+
+int main()
+{
+	if ( !TestEmptyQueue() )
+	{
+		fprintf( stderr, "ThreadSafeQueue: reading an empty queue\n" );
+		return 1;
+	}
+	for ( int i = 0; i < 5; ++i )
+	{
+		if ( TestWriters() != 0 )
+			return 1;
+	}
+	printf( "ThreadSafeQueue: ok\n" );
+	return 0;
+}